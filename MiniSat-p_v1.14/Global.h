@@ -59,17 +59,17 @@ template <> struct STATIC_ASSERTION_FAILURE<true>{};
 
 
 //=================================================================================================
-// 'malloc()'-style memory allocation -- never returns NULL; aborts instead:
+// 'malloc()'-style memory allocation -- never returns NULL; throws 'std::bad_alloc' instead:
 
 
 template<class T> static inline T* xmalloc(size_t size) {
     T*   tmp = (T*)malloc(size * sizeof(T));
-    assert(size == 0 || tmp != NULL);
+    if (size != 0 && tmp == NULL) throw std::bad_alloc();
     return tmp; }
 
 template<class T> static inline T* xrealloc(T* ptr, size_t size) {
     T*   tmp = (T*)realloc((void*)ptr, size * sizeof(T));
-    assert(size == 0 || tmp != NULL);
+    if (size != 0 && tmp == NULL) throw std::bad_alloc();
     return tmp; }
 
 template<class T> static inline void xfree(T *ptr) {
@@ -174,6 +174,7 @@ public:
 
     // Size operations:
     int      size   (void) const       { return sz; }
+    int      capacity(void) const      { return cap; }
     void     shrink (int nelems)       { assert(nelems <= sz); for (int i = 0; i < nelems; i++) sz--, data[sz].~T(); }
     void     pop    (void)             { sz--, data[sz].~T(); }
     void     growTo (int size);
@@ -45,6 +45,9 @@ class Proof {
     cchar*          fp_name;
     ClauseId        id_counter;
     ProofTraverser* trav;
+    uint64          bytes_logged;
+
+    void            put(uint64 val);    // 'putUInt()' if a file is open, with byte accounting in both modes.
 
     vec<Lit>        clause;
     vec<ClauseId>   chain_id;
@@ -60,6 +63,7 @@ public:
     ClauseId endChain  ();
     void     deleted   (ClauseId gone);
     ClauseId last      () { assert(id_counter != ClauseId_NULL); return id_counter - 1; }
+    uint64   bytes     () const { return bytes_logged; }    // Size of the proof logged so far in the file encoding (also counted in online mode).
 
     void     compress  (Proof& dst, ClauseId goal = ClauseId_NULL);     // 'dst' should be a newly constructed, empty proof.
     bool     save      (cchar* filename);
@@ -23,6 +23,7 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "SolverTypes.h"
 #include "VarOrder.h"
 #include "Proof.h"
+#include <atomic>
 
 // Redfine if you want output to go somewhere else:
 #define reportf(format, args...) ( printf(format , ## args), fflush(stdout) )
@@ -46,6 +47,10 @@ struct SearchParams {
 };
 
 
+// Thrown by 'solve()' when the solver is interrupted from another thread:
+struct Interrupted { };
+
+
 class Solver {
 protected:
     // Solver state:
@@ -136,6 +141,7 @@ public:
              , expensive_ccmin  (true)
              , proof            (NULL)
              , verbosity        (0)
+             , interrupt        (NULL)
              , progress_estimate(0)
              , conflict_id      (ClauseId_NULL)
              {
@@ -173,6 +179,8 @@ public:
     bool            expensive_ccmin;    // Controls conflict clause minimization. TRUE by default.
     Proof*          proof;              // Set this directly after constructing 'Solver' to enable proof logging. Initialized to NULL.
     int             verbosity;          // Verbosity level. 0=silent, 1=some progress report, 2=everything
+    const std::atomic<bool>* interrupt; // If set, 'solve()' throws 'Interrupted' at the next conflict or restart after '*interrupt' becomes TRUE.
+    void    setRandomSeed(double seed) { order.setSeed(seed); }
 
     // Problem specification:
     //
@@ -190,6 +198,11 @@ public:
     bool    solve(const vec<Lit>& assumps);
     bool    solve() { vec<Lit> tmp; return solve(tmp); }
 
+    // Memory:
+    //
+    uint64  clauseBytes() const;        // Bytes held by the problem and learnt clauses.
+    uint64  watchBytes () const;        // Bytes held by the watch lists.
+
     double      progress_estimate;  // Set by 'search()'.
     vec<lbool>  model;              // If problem is satisfiable, this vector contains the model (if any).
     vec<Lit>    conflict;           // If problem is unsatisfiable under assumptions, this vector represent the conflict clause expressed in the assumptions.
@@ -44,6 +44,7 @@ public:
         assigns(ass), activity(act), heap(VarOrder_lt(act)), random_seed(91648253)
         { }
 
+    void        setSeed(double seed) { random_seed = seed; }
     inline void newVar(void);
     inline void update(Var x);                  // Called when variable increased in activity.
     inline void undo(Var x);                    // Called when variable is unassigned and may be selected again.
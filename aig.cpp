@@ -0,0 +1,302 @@
+#include "aig.h"
+#include "MiniSat-p_v1.14/Solver.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+
+using namespace std;
+
+AigManager::AigManager() {
+  nodes.push_back({lit_Undef, lit_Undef});
+  label.push_back(var_Undef);
+  fanout.push_back(0);
+}
+
+// Every entry of a hash map is a separate allocation holding its key, value and a link
+size_t AigManager::bytes() const {
+  return nodes.capacity() * sizeof(AigNode) + label.capacity() * sizeof(Var) + fanout.capacity() * sizeof(unsigned)
+    + (ands.bucket_count() + inputs.bucket_count()) * sizeof(void*)
+    + ands.size() * (sizeof(pair<uint64, int>) + sizeof(void*))
+    + inputs.size() * (sizeof(pair<Var, int>) + sizeof(void*));
+}
+
+Lit AigManager::input(Lit x) {
+  auto it = inputs.find(var(x));
+  if(it != inputs.end())
+    return Lit(it->second, sign(x));
+
+  int n = nodes.size();
+  nodes.push_back({lit_Undef, lit_Undef});
+  label.push_back(var(x));
+  fanout.push_back(0);
+  inputs[var(x)] = n;
+  return Lit(n, sign(x));
+}
+
+Lit AigManager::make_and(Lit a, Lit b) {
+  // Constant folding and trivial cases
+  if(a == aig_false || b == aig_false || a == ~b)
+    return aig_false;
+  if(a == aig_true || a == b)
+    return b;
+  if(b == aig_true)
+    return a;
+
+  // Structural hashing, children are ordered
+  if(b < a)
+    swap(a, b);
+  uint64 key = ((uint64)index(a) << 32) | (unsigned)index(b);
+  auto it = ands.find(key);
+  if(it != ands.end())
+    return Lit(it->second);
+
+  int n = nodes.size();
+  nodes.push_back({a, b});
+  label.push_back(var_Undef);
+  fanout.push_back(0);
+  fanout[var(a)]++;
+  fanout[var(b)]++;
+  ands[key] = n;
+  return Lit(n);
+}
+
+Lit AigManager::make_iff(Lit a, Lit b) {
+  return make_and(~make_and(a, ~b), ~make_and(~a, b));
+}
+
+Lit AigManager::make_and(const vec<Lit>& lits) {
+  // Balanced, so that subsets of the same conjuncts are more likely to be shared
+  vector<Lit> level;
+  for(int i = 0; i < lits.size(); i++)
+    level.push_back(lits[i]);
+  if(level.empty())
+    return aig_true;
+  while(level.size() > 1) {
+    vector<Lit> next;
+    for(size_t i = 0; i + 1 < level.size(); i += 2)
+      next.push_back(make_and(level[i], level[i+1]));
+    if(level.size() % 2)
+      next.push_back(level.back());
+    level.swap(next);
+  }
+  return level[0];
+}
+
+// Collects the conjuncts of n, looking through positive conjunctions without other fanout
+void AigManager::collect_conjuncts(int n, vec<Lit>& leaves) {
+  vector<Lit> todo = {nodes[n].right, nodes[n].left};
+  while(!todo.empty()) {
+    Lit c = todo.back();
+    todo.pop_back();
+    int m = var(c);
+    if(!sign(c) && is_and(m) && label[m] == var_Undef && fanout[m] == 1) {
+      todo.push_back(nodes[m].right);
+      todo.push_back(nodes[m].left);
+    } else
+      leaves.push(c);
+  }
+}
+
+Lit AigManager::encode(Lit x, Var *next_free, vec<vec<Lit>>& result) {
+  // Post-order with an explicit stack, interpolants can be very deep
+  vector<pair<int, bool>> stack = {{var(x), false}};
+  vec<Lit> leaves;
+  while(!stack.empty()) {
+    int n = stack.back().first;
+    if(label[n] != var_Undef) {
+      stack.pop_back();
+      continue;
+    }
+
+    if(n == 0) {
+      // The constant gets a label fixed by a unit clause
+      label[0] = *next_free; *next_free += 1;
+      encoded++;
+      result.push(); result.last().push(~Lit(label[0]));
+      stack.pop_back();
+      continue;
+    }
+
+    leaves.clear();
+    collect_conjuncts(n, leaves);
+    if(!stack.back().second) {
+      stack.back().second = true;
+      for(int i = 0; i < leaves.size(); i++)
+	if(label[var(leaves[i])] == var_Undef)
+	  stack.push_back({var(leaves[i]), false});
+      continue;
+    }
+    stack.pop_back();
+
+    // l <-> (x_1 /\ ... /\ x_n): (~l or x_i) for all i and (l or ~x_1 or ... or ~x_n)
+    Lit l = Lit(*next_free); *next_free += 1;
+    label[n] = var(l);
+    encoded++;
+    vec<Lit> lits;
+    lits.push(l);
+    for(int i = 0; i < leaves.size(); i++) {
+      Lit leaf = Lit(label[var(leaves[i])], sign(leaves[i]));
+      result.push(); result.last().push(~l); result.last().push(leaf);
+      lits.push(~leaf);
+    }
+    result.push(); lits.copyTo(result.last());
+  }
+  return Lit(label[var(x)], sign(x));
+}
+
+vector<int> AigManager::cone(Lit x) {
+  vector<int> result;
+  vector<bool> seen(nodes.size(), false);
+  vector<int> todo = {var(x)};
+  seen[var(x)] = true;
+  while(!todo.empty()) {
+    int n = todo.back();
+    todo.pop_back();
+    result.push_back(n);
+    if(!is_and(n))
+      continue;
+    for(Lit c : {nodes[n].left, nodes[n].right})
+      if(!seen[var(c)]) {
+	seen[var(c)] = true;
+	todo.push_back(var(c));
+      }
+  }
+  // Children are always created before their parents
+  sort(result.begin(), result.end());
+  return result;
+}
+
+int AigManager::cone_size(Lit x) {
+  int size = 0;
+  for(int n : cone(x))
+    if(is_and(n) && label[n] == var_Undef)
+      size++;
+  return size;
+}
+
+Lit AigManager::sweep(Lit x, double budget, const SolverOptions& options) {
+  auto start = chrono::steady_clock::now();
+  auto expired = [&]() {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count() > budget;
+  };
+
+  // Simulate the cone on 64 * words random patterns
+  const int words = 4;
+  vector<int> order = cone(x);
+  if(order[0] != 0)
+    order.insert(order.begin(), 0);
+  unordered_map<int, int> slot;
+  vector<uint64> sim(order.size() * words);
+  uint64 seed = 0x9e3779b97f4a7c15ULL;
+  for(size_t i = 0; i < order.size(); i++) {
+    int n = order[i];
+    slot[n] = i;
+    uint64 *w = &sim[i * words];
+    if(n == 0)
+      fill(w, w + words, 0);
+    else if(!is_and(n))
+      for(int k = 0; k < words; k++) {
+	// xorshift64
+	seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+	w[k] = seed;
+      }
+    else {
+      Lit l = nodes[n].left, r = nodes[n].right;
+      uint64 *wl = &sim[slot[var(l)] * words], *wr = &sim[slot[var(r)] * words];
+      for(int k = 0; k < words; k++)
+	w[k] = (wl[k] ^ (sign(l) ? ~0ULL : 0)) & (wr[k] ^ (sign(r) ? ~0ULL : 0));
+    }
+  }
+
+  // Candidate classes by normalized simulation signature, the first pattern is always false
+  // Members are literals of the rewritten graph with the normalized function
+  map<vector<uint64>, vector<Lit>> classes;
+  auto signature = [&](int n, bool& phase) {
+    uint64 *w = &sim[slot[n] * words];
+    phase = w[0] & 1;
+    vector<uint64> sig(w, w + words);
+    if(phase)
+      for(uint64& k : sig)
+	k = ~k;
+    return sig;
+  };
+
+  // Equivalences are proven in a solver with variable n for node n
+  Solver s;
+  configure(s, options);
+  vector<bool> defined;
+  auto define = [&](Lit y) {
+    vector<int> todo = {var(y)};
+    while(!todo.empty()) {
+      int n = todo.back();
+      todo.pop_back();
+      while(s.nVars() <= n)
+	s.newVar();
+      if((int)defined.size() <= n)
+	defined.resize(n + 1, false);
+      if(defined[n])
+	continue;
+      defined[n] = true;
+      if(n == 0)
+	s.addClause(vec<Lit>(1, ~Lit(0)));
+      else if(is_and(n)) {
+	vec<vec<Lit>> clauses;
+	tseitin_and(Lit(n), nodes[n].left, nodes[n].right, clauses);
+	for(int i = 0; i < clauses.size(); i++)
+	  s.addClause(clauses[i]);
+	todo.push_back(var(nodes[n].left));
+	todo.push_back(var(nodes[n].right));
+      }
+    }
+  };
+  auto equivalent = [&](Lit a, Lit b) {
+    define(a);
+    define(b);
+    vec<Lit> assumps;
+    assumps.push(a); assumps.push(~b);
+    if(s.solve(assumps))
+      return false;
+    assumps.clear();
+    assumps.push(~a); assumps.push(b);
+    if(s.solve(assumps))
+      return false;
+    // Keep the proven equivalence for later checks
+    vec<Lit> lits;
+    lits.push(~a); lits.push(b); s.addClause(lits); lits.clear();
+    lits.push(a); lits.push(~b); s.addClause(lits);
+    return true;
+  };
+
+  // Rewrite bottom up, every node is replaced by an equivalent literal
+  unordered_map<int, Lit> repl;
+  auto rewritten = [&](Lit y) { Lit r = repl[var(y)]; return sign(y) ? ~r : r; };
+  for(int n : order) {
+    bool phase;
+    vector<uint64> sig = signature(n, phase);
+    vector<Lit>& members = classes[sig];
+
+    if(!is_and(n) || label[n] != var_Undef) {
+      // Inputs, the constant and encoded nodes stay
+      repl[n] = Lit(n);
+      members.push_back(phase ? ~Lit(n) : Lit(n));
+      continue;
+    }
+
+    Lit m = make_and(rewritten(nodes[n].left), rewritten(nodes[n].right));
+    Lit normalized = phase ? ~m : m;
+    repl[n] = m;
+    bool merged = false;
+    for(Lit c : members) {
+      if(c == normalized || (!expired() && equivalent(normalized, c))) {
+	repl[n] = phase ? ~c : c;
+	merged = true;
+	break;
+      }
+    }
+    if(!merged)
+      members.push_back(normalized);
+  }
+
+  return rewritten(x);
+}
@@ -0,0 +1,66 @@
+#ifndef AIG_H
+#define AIG_H
+
+#include "MiniSat-p_v1.14/Global.h"
+#include "MiniSat-p_v1.14/SolverTypes.h"
+#include "util.h"
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+// Literals of an AigManager are literals over its nodes, node 0 is the constant false
+const Lit aig_false = Lit(0);
+const Lit aig_true = ~Lit(0);
+
+// Structurally hashed and-inverter graph, used for interpolants and the initial states
+// Identical nodes are shared, also between formulas built at different times
+// Nodes are translated to cnf on demand and every node at most once
+class AigManager {
+public:
+  AigManager();
+
+  // Literal standing for the solver literal x
+  Lit input(Lit x);
+  Lit make_and(Lit a, Lit b);
+  Lit make_or(Lit a, Lit b) { return ~make_and(~a, ~b); }
+  Lit make_iff(Lit a, Lit b);
+  // Conjunction of all literals in lits, true if empty
+  Lit make_and(const vec<Lit>& lits);
+
+  // Adds tseitin definitions of the nodes in the cone of x that have not been encoded yet to result
+  // Labels are taken from next_free and incremented, returns the solver literal of x
+  // A tree of conjunctions whose inner nodes have no other fanout gets a single n-ary definition
+  Lit encode(Lit x, Var *next_free, vec<vec<Lit>>& result);
+
+  // SAT sweeping: merges the nodes in the cone of x that are equivalent to other nodes or constant
+  // Candidates are found by random simulation and proven with a SAT solver, nodes encoded before are kept
+  // Stops trying to merge after budget seconds, returns the rewritten literal equivalent to x
+  Lit sweep(Lit x, double budget, const SolverOptions& options = SolverOptions());
+  // Number of conjunctions in the cone of x that encode would translate
+  int cone_size(Lit x);
+
+  int size() { return nodes.size(); }
+  // Bytes held by the nodes and their hash tables
+  size_t bytes() const;
+  // Number of nodes that got a label by encode
+  int encoded = 0;
+
+private:
+  // Children of a conjunction, left is lit_Undef for inputs and the constant
+  struct AigNode {
+    Lit left, right;
+  };
+  vector<AigNode> nodes;
+  // Solver variable of every node, var_Undef until it is encoded
+  vector<Var> label;
+  vector<unsigned> fanout;
+  unordered_map<uint64, int> ands;
+  unordered_map<Var, int> inputs;
+
+  bool is_and(int n) { return nodes[n].left != lit_Undef; }
+  // All nodes in the cone of x in topological order
+  vector<int> cone(Lit x);
+  void collect_conjuncts(int n, vec<Lit>& leaves);
+};
+#endif
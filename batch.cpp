@@ -0,0 +1,162 @@
+#include "batch.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// A file being checked by a child
+struct Worker {
+  string file;
+  // Read end of the pipe the child reports its result on
+  int fd;
+  chrono::steady_clock::time_point start;
+  bool timed_out = false;
+};
+
+// Sorted names of the aiger files in dir
+static vector<string> aiger_files(const string& dir) {
+  DIR *d = opendir(dir.c_str());
+  if(d == NULL)
+    throw runtime_error("cannot open directory " + dir);
+  vector<string> files;
+  while(struct dirent *e = readdir(d)) {
+    string name = e->d_name;
+    if(name.size() > 4 && (name.compare(name.size() - 4, 4, ".aag") == 0 || name.compare(name.size() - 4, 4, ".aig") == 0))
+      files.push_back(name);
+  }
+  closedir(d);
+  sort(files.begin(), files.end());
+  return files;
+}
+
+// glibc reserves 64 MB of address space for the heap of every thread, which would count against the
+// limit long before it is used. All threads share the main heap instead
+void limit_memory(int megabytes) {
+  mallopt(M_ARENA_MAX, 1);
+  struct rlimit r;
+  r.rlim_cur = r.rlim_max = (rlim_t)megabytes << 20;
+  setrlimit(RLIMIT_AS, &r);
+}
+
+// Runs in the child: applies the memory limit, checks the file and writes
+// "verdict\tcounter\t...\n" to fd. Output of the engines is discarded
+static void check_child(const string& path, const BatchLimits& limits, size_t nr_counters, BatchCheck& check, int fd) {
+  int null = open("/dev/null", O_WRONLY);
+  if(null >= 0)
+    dup2(null, STDOUT_FILENO);
+  if(limits.memory > 0)
+    limit_memory(limits.memory);
+
+  string line;
+  try {
+    vector<uint64> counters(nr_counters, 0);
+    line = check(path, counters);
+    for(uint64 c : counters)
+      line += "\t" + to_string(c);
+  }
+  catch(const bad_alloc&) {
+    line = "MEMOUT";
+  }
+  catch(const exception&) {
+    line = "ERROR";
+  }
+  line += "\n";
+  if(write(fd, line.data(), line.size()) < 0)
+    _exit(1);
+  _exit(0);
+}
+
+void run_batch(const string& dir, const BatchLimits& limits, const vector<string>& counter_names,
+	       BatchCheck check, ostream& out) {
+  vector<string> files = aiger_files(dir);
+  out << "file,verdict,wall_s,cpu_s,peak_rss_kb";
+  for(const string& name : counter_names)
+    out << "," << name;
+  out << endl;
+
+  map<pid_t, Worker> running;
+  size_t next = 0;
+  while(next < files.size() || !running.empty()) {
+    while(next < files.size() && (int)running.size() < limits.jobs) {
+      const string& file = files[next++];
+      int fds[2];
+      if(pipe(fds) < 0)
+	throw runtime_error("cannot create pipe");
+      // Nothing buffered may be written twice
+      out.flush();
+      pid_t pid = fork();
+      if(pid < 0)
+	throw runtime_error("cannot fork");
+      if(pid == 0) {
+	close(fds[0]);
+	check_child(dir + "/" + file, limits, counter_names.size(), check, fds[1]);
+      }
+      close(fds[1]);
+      Worker& w = running[pid];
+      w.file = file;
+      w.fd = fds[0];
+      w.start = chrono::steady_clock::now();
+    }
+
+    int status;
+    struct rusage usage;
+    pid_t pid = wait4(-1, &status, WNOHANG, &usage);
+    if(pid <= 0) {
+      auto now = chrono::steady_clock::now();
+      for(auto& r : running)
+	if(limits.time > 0 && !r.second.timed_out
+	   && chrono::duration<double>(now - r.second.start).count() > limits.time) {
+	  kill(r.first, SIGKILL);
+	  r.second.timed_out = true;
+	}
+      this_thread::sleep_for(chrono::milliseconds(5));
+      continue;
+    }
+
+    Worker w = running[pid];
+    running.erase(pid);
+    chrono::duration<double> wall = chrono::steady_clock::now() - w.start;
+    string result;
+    char buffer[4096];
+    ssize_t n;
+    while((n = read(w.fd, buffer, sizeof(buffer))) > 0)
+      result.append(buffer, n);
+    close(w.fd);
+
+    // The result line is only trusted if the child exited normally
+    vector<string> fields;
+    if(w.timed_out)
+      fields.push_back("TIMEOUT");
+    else if(WIFSIGNALED(status))
+      fields.push_back("CRASH (signal " + to_string(WTERMSIG(status)) + ")");
+    else if(WEXITSTATUS(status) != 0 || result.empty() || result.back() != '\n')
+      fields.push_back("ERROR");
+    else {
+      stringstream line(result.substr(0, result.size() - 1));
+      string field;
+      while(getline(line, field, '\t'))
+	fields.push_back(field);
+    }
+    fields.resize(1 + counter_names.size());
+
+    double cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    out << w.file << "," << fields[0] << "," << fixed << setprecision(3) << wall.count() << "," << cpu
+	<< "," << usage.ru_maxrss;
+    for(size_t i = 1; i < fields.size(); i++)
+      out << "," << fields[i];
+    out << endl;
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "MiniSat-p_v1.14/Global.h"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Limits of a batch run, a limit of 0 means none
+struct BatchLimits {
+  // Number of files checked at the same time
+  int jobs = 1;
+  // Wall clock seconds and megabytes of address space per file
+  double time = 0;
+  int memory = 0;
+};
+
+// Checks one file, returns its verdict (a single line) and sets one counter per counter name
+// Throws if the file cannot be checked
+typedef function<string(const string& file, vector<uint64>& counters)> BatchCheck;
+
+// Limits the address space of this process, allocations beyond it throw bad_alloc
+void limit_memory(int megabytes);
+
+// Checks every .aag and .aig file of dir with a pool of limits.jobs workers
+// Every file is checked in a forked child of this process, so each one gets its own limits and the kernel
+// measures its CPU time and peak RSS. Writes a CSV row per file to out as soon as it is done: the verdict
+// (or TIMEOUT, MEMOUT, ERROR, CRASH), wall and CPU time in seconds, peak RSS in KB and the counters
+void run_batch(const string& dir, const BatchLimits& limits, const vector<string>& counter_names,
+	       BatchCheck check, ostream& out);
+#endif
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <unistd.h>
+#include "transition_system.h"
+
+using namespace std;
+
+// Parse throughput benchmark
+// Parses every given file repeatedly and reports its throughput in MB/s
+// Totals are reported separately for ASCII (aag) and binary (aig) inputs, so
+// passing both versions of a suite compares the two parsers
+int main(int argc, char* argv[]) {
+  int opt;
+  int repetitions = 5;
+
+  while ((opt = getopt(argc, argv, "r:")) != -1) {
+    switch (opt)
+      {
+      case 'r':
+	repetitions = stoi(optarg);
+	break;
+      default:
+	cout << "Usage: " << argv[0] << " [-r repetitions] file..." << endl;
+	return 1;
+      }
+  }
+
+  // Index 0 is ASCII, index 1 binary
+  double total_bytes[2] = {0, 0};
+  double total_seconds[2] = {0, 0};
+
+  for(int i = optind; i < argc; i++) {
+    ifstream file(argv[i], ios::binary | ios::ate);
+    if(!file.is_open()) {
+      cerr << "Cannot open " << argv[i] << endl;
+      continue;
+    }
+    double bytes = file.tellg();
+    file.seekg(0);
+    string header;
+    file >> header;
+    file.close();
+    int binary = header == "aig";
+
+    double best = -1;
+    int gates = 0;
+    try {
+      for(int r = 0; r < repetitions; r++) {
+	TransitionSystem t;
+	auto start = chrono::steady_clock::now();
+	t.parse(argv[i]);
+	chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+	if(best < 0 || elapsed.count() < best)
+	  best = elapsed.count();
+	gates = t.nr_gates;
+      }
+    }
+    catch(const exception& e) {
+      cerr << "Error while parsing " << argv[i] << ": " << e.what() << endl;
+      continue;
+    }
+
+    total_bytes[binary] += bytes;
+    total_seconds[binary] += best;
+    cout << argv[i] << " " << header << " " << (long)bytes << " bytes " << gates << " gates "
+	 << best * 1000 << " ms " << bytes / (1 << 20) / best << " MB/s" << endl;
+  }
+
+  const char* names[2] = {"aag", "aig"};
+  for(int f = 0; f < 2; f++)
+    if(total_seconds[f] > 0)
+      cout << "Total " << names[f] << ": " << (long)total_bytes[f] << " bytes in " << total_seconds[f] * 1000
+	   << " ms, " << total_bytes[f] / (1 << 20) / total_seconds[f] << " MB/s" << endl;
+  return 0;
+}
@@ -0,0 +1,274 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "traverser.h"
+#include "aig.h"
+#include "util.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+// Micro-benchmarks of the hot paths: parsing, cnf encoding, propagation, proof ingestion and interpolation
+// Every benchmark runs once to warm up and then -r times per file. The results are written as JSON:
+// mean, standard deviation, minimum and maximum time of a run in ms, and the work done by a run
+// The work is the same in every run of a benchmark. Two results are only comparable if it is equal,
+// otherwise the change altered what is computed and not just how fast
+
+// Settings of all benchmarks
+static int repetitions = 10;
+// Number of frames encoded, propagated and refuted
+static int frames = 10;
+// Rounds of decisions per run of the propagation benchmark
+static const int rounds = 32;
+
+struct Result {
+  string file;
+  string name;
+  string unit;
+  uint64 work = 0;
+  vector<double> ms;
+};
+
+static vector<Result> results;
+
+// Times run repetitions times after a warm-up run, prepare is called untimed before every run
+// run returns the work it has done
+static void measure(const string& file, const string& name, const string& unit,
+		    function<void()> prepare, function<uint64()> run) {
+  Result r;
+  r.file = file;
+  r.name = name;
+  r.unit = unit;
+  for(int i = 0; i <= repetitions; i++) {
+    prepare();
+    auto start = chrono::steady_clock::now();
+    r.work = run();
+    chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+    if(i > 0)
+      r.ms.push_back(elapsed.count());
+  }
+  results.push_back(r);
+}
+
+// Exposes the propagation loop of the solver
+struct PropagationSolver : public Solver {
+  // Assigns the literals of decisions one decision level each and propagates after every one,
+  // until all are assigned or a conflict occurs. Returns to level 0 afterwards
+  void decide(const vec<Lit>& decisions) {
+    for(int i = 0; i < decisions.size(); i++) {
+      if(value(decisions[i]) != l_Undef)
+	continue;
+      assume(decisions[i]);
+      if(propagate() != NULL)
+	break;
+    }
+    cancelUntil(0);
+  }
+};
+
+// Passes the proof recorded by from to the traverser to, in the order the solver produced it
+// Returns the number of resolutions
+static uint64 replay(const Traverser& from, Traverser& to) {
+  uint64 resolutions = 0;
+  vec<Lit> clause;
+  vec<ClauseId> cs;
+  vec<Var> xs;
+  for(size_t id = 0; id < from.kind.size(); id++) {
+    int i = from.start[id], end = from.start[id + 1];
+    if(from.kind[id] == Traverser::derived) {
+      cs.clear();
+      xs.clear();
+      cs.push(from.trace[i]);
+      for(i++; i < end; i += 2) {
+	xs.push(from.trace[i]);
+	cs.push(from.trace[i + 1]);
+      }
+      to.chain(cs, xs);
+      resolutions += xs.size();
+    } else {
+      clause.clear();
+      for(; i < end; i++)
+	clause.push(toLit(from.trace[i]));
+      to.init = (Trivial)from.kind[id];
+      to.root(clause);
+    }
+  }
+  return resolutions;
+}
+
+static void bench_file(const string& file) {
+  measure(file, "parse", "bytes", []{}, [&]{
+      TransitionSystem t;
+      return (uint64)t.parse(file);
+    });
+
+  // The remaining benchmarks work on the transition system as the checker sees it
+  TransitionSystem t;
+  t.parse(file);
+  t.simplify();
+  t.reduce_coi();
+  int width = t.max_index + 1;
+
+  vec<vec<Lit>> clauses;
+  measure(file, "circuit_cnf", "clauses", [&]{ clauses.clear(true); }, [&]{
+      t.circuit_cnf(clauses, 0);
+      return (uint64)clauses.size();
+    });
+  measure(file, "transition_cnf", "clauses", [&]{ clauses.clear(true); }, [&]{
+      for(int i = 0; i < frames; i++)
+	t.transition_cnf(clauses, i);
+      return (uint64)clauses.size();
+    });
+
+  // Initial states and frames 0..frames, every round decides all inputs with random values
+  PropagationSolver s;
+  while(s.nVars() < (frames + 1) * width) { s.newVar(); }
+  clauses.clear();
+  t.initial_cnf(clauses);
+  for(int i = 0; i < frames; i++)
+    t.transition_cnf(clauses, i);
+  for(int i = 0; i < clauses.size(); i++)
+    s.addClause(clauses[i]);
+  s.simplifyDB();
+  vector<bool> is_input(width, true);
+  is_input[var(t.const_false)] = false;
+  for(pair<Lit, Lit> latch : t.latches)
+    is_input[var(latch.first)] = false;
+  for(Lit x : t.gate_lhs)
+    is_input[var(x)] = false;
+  mt19937 rng(1);
+  vector<vec<Lit>> decisions(rounds);
+  for(int r = 0; r < rounds; r++)
+    for(int i = 0; i <= frames; i++)
+      for(Var x = 0; x < width; x++)
+	if(is_input[x] && t.fanout[x] > 0)
+	  decisions[r].push(Lit(x + i * width, rng() & 1));
+  if(s.okay())
+    measure(file, "propagate", "propagations", []{}, [&]{
+	int64 before = s.stats.propagations;
+	for(int r = 0; r < rounds; r++)
+	  s.decide(decisions[r]);
+	return (uint64)(s.stats.propagations - before);
+      });
+
+  // Proof of the interpolation query of bound frames, with the localities of the interpolation-based checker:
+  // A = I /\ T(0) and B = T(1) /\ ... /\ T(frames-1) /\ (bad_1 \/ ... \/ bad_frames)
+  Solver p;
+  Traverser recorded;
+  unique_ptr<Proof> proof(attach_proof(p, proof_online, &recorded));
+  while(p.nVars() < (frames + 1) * width) { p.newVar(); }
+  clauses.clear();
+  t.initial_cnf(clauses);
+  t.transition_cnf(clauses, 0);
+  recorded.init = int_f;
+  for(int i = 0; i < clauses.size(); i++)
+    p.addClause(clauses[i]);
+  clauses.clear();
+  for(int i = 1; i < frames; i++)
+    t.transition_cnf(clauses, i);
+  t.bad_cnf(clauses, 1, frames);
+  recorded.init = int_t;
+  for(int i = 0; i < clauses.size(); i++)
+    p.addClause(clauses[i]);
+  if(p.solve()) {
+    cerr << file << ": property fails within " << frames << " steps, proof benchmarks skipped" << endl;
+    return;
+  }
+  ClauseId goal = p.okay() ? p.conflict_id : proof->last();
+
+  vector<char> locality((frames + 1) * width, local_b);
+  fill(locality.begin(), locality.begin() + 2 * width, local_a);
+  for(pair<Lit, Lit> latch : t.latches)
+    locality[var(latch.second) + width] = shared_ab;
+  locality[var(t.output) + width] = shared_ab;
+
+  unique_ptr<Traverser> trav;
+  measure(file, "chain", "resolutions", [&]{ trav.reset(new Traverser()); }, [&]{
+      return replay(recorded, *trav);
+    });
+  measure(file, "finalize", "core_clauses", [&]{ trav.reset(new Traverser()); replay(recorded, *trav); }, [&]{
+      return (uint64)trav->finalize(goal);
+    });
+
+  ResolutionForest forest;
+  unique_ptr<AigManager> aig;
+  measure(file, "compute_partial_interpolant", "nodes", [&]{ forest = trav->forest; aig.reset(new AigManager()); }, [&]{
+      forest.compute_partial_interpolant(forest.roots[goal], locality, width, *aig);
+      return (uint64)forest.nodes.size();
+    });
+}
+
+static string json_string(const string& s) {
+  string result = "\"";
+  for(char c : s) {
+    if(c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result + "\"";
+}
+
+int main(int argc, char* argv[]) {
+  int opt;
+
+  while ((opt = getopt(argc, argv, "r:k:")) != -1) {
+    switch (opt)
+      {
+      case 'r':
+	repetitions = stoi(optarg);
+	break;
+      case 'k':
+	frames = stoi(optarg);
+	break;
+      default:
+	cerr << "Usage: " << argv[0] << " [-r repetitions] [-k frames] file..." << endl;
+	return 1;
+      }
+  }
+
+  if(repetitions < 1 || frames < 1) {
+    cerr << "Repetitions and frames have to be positive" << endl;
+    return 1;
+  }
+
+  for(int i = optind; i < argc; i++) {
+    try {
+      bench_file(argv[i]);
+    }
+    catch(const exception& e) {
+      cerr << "Error while benchmarking " << argv[i] << ": " << e.what() << endl;
+    }
+  }
+
+  cout << "{" << endl;
+  cout << "  \"repetitions\": " << repetitions << "," << endl;
+  cout << "  \"frames\": " << frames << "," << endl;
+  cout << "  \"results\": [" << endl;
+  for(size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    double mean = 0, variance = 0, min = r.ms[0], max = r.ms[0];
+    for(double x : r.ms) {
+      mean += x / r.ms.size();
+      min = std::min(min, x);
+      max = std::max(max, x);
+    }
+    for(double x : r.ms)
+      variance += (x - mean) * (x - mean) / std::max<size_t>(1, r.ms.size() - 1);
+    cout << "    {\"file\": " << json_string(r.file) << ", \"benchmark\": " << json_string(r.name)
+	 << ", \"work\": " << r.work << ", \"unit\": " << json_string(r.unit)
+	 << ", \"mean_ms\": " << mean << ", \"stddev_ms\": " << sqrt(variance)
+	 << ", \"min_ms\": " << min << ", \"max_ms\": " << max << "}"
+	 << (i + 1 < results.size() ? "," : "") << endl;
+  }
+  cout << "  ]" << endl;
+  cout << "}" << endl;
+  return 0;
+}
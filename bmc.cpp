@@ -0,0 +1,63 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "bmc.h"
+#include "util.h"
+
+using namespace std;
+
+IncrementalBMC::IncrementalBMC(TransitionSystem& t, int verbosity, ProofPolicy policy, const SolverOptions& options)
+  : t(t), verbosity(verbosity) {
+  proof.reset(attach_proof(s, policy));
+  configure(s, options);
+  vec<vec<Lit>> clauses;
+  t.initial_latches_cnf(clauses);
+  add_clauses(clauses);
+}
+
+void IncrementalBMC::add_clauses(vec<vec<Lit>>& clauses) {
+  for(int i = 0; i < clauses.size(); i++)
+    for(int j = 0; j < clauses[i].size(); j++)
+      while(var(clauses[i][j]) >= s.nVars()) { s.newVar(); }
+
+  for(int i = 0; i < clauses.size(); i++)
+    s.addClause(clauses[i]);
+}
+
+// Unrolls frames checked+1..k one at a time
+// The bad literal of the newest frame is the only assumption, so it acts as the frame's
+// activation literal. Once a bound is proven its bad literal is asserted false, which
+// retires the query and keeps everything learnt so far valid for the next bound
+// For bound i, frame f only holds the logic within i - f steps of the output. Each new
+// bound extends every frame by the next layer of the cone, so nothing is encoded twice
+// No interpolants are computed here, so the polarity based encoding suffices
+bool IncrementalBMC::check(int k) {
+  vec<vec<Lit>> clauses;
+  vec<Lit> assumps;
+
+  for(int i = checked + 1; i <= k; i++) {
+    for(int f = 0; f <= i; f++)
+      t.cone_cnf(clauses, f, i - f, false);
+    add_clauses(clauses);
+    clauses.clear();
+
+    Lit bad = shift_literal(t.output, i * (t.max_index + 1));
+    while(var(bad) >= s.nVars()) { s.newVar(); }
+
+    assumps.clear();
+    assumps.push(bad);
+    if(s.solve(assumps)) {
+      if(verbosity == 2) { print_model(s); }
+      return false;
+    }
+
+    // Unsatisfiable without assumptions, every deeper bound is unsatisfiable as well
+    if(!s.okay()) {
+      checked = k;
+      return true;
+    }
+
+    s.addUnit(~bad);
+    checked = i;
+  }
+  return true;
+}
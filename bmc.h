@@ -0,0 +1,34 @@
+#ifndef BMC_H
+#define BMC_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "util.h"
+#include "stats.h"
+#include <memory>
+
+// Incremental bounded model checker
+// Keeps a single solver alive, unrolls one frame per bound and checks each frame's
+// bad literal under an assumption. Learnt clauses are kept between bounds.
+class IncrementalBMC {
+public:
+  IncrementalBMC(TransitionSystem& t, int verbosity = 0, ProofPolicy policy = proof_none,
+		 const SolverOptions& options = SolverOptions());
+  // Returns true iff property is not violated up to bound k
+  bool check(int k);
+  // Highest bound for which the property is known to hold, -1 if none
+  int checked = -1;
+  // True if the property is known to hold for every bound
+  bool proven() { return !s.okay(); }
+  // Work of the solver so far
+  const SolverStats& solver_stats() { return s.stats; }
+  // Sets the bytes held by the solver in m
+  void memory(MemoryStats& m) const { m.bmc_clauses = s.clauseBytes(); m.bmc_watches = s.watchBytes(); }
+private:
+  TransitionSystem& t;
+  Solver s;
+  unique_ptr<Proof> proof;
+  int verbosity;
+  void add_clauses(vec<vec<Lit>>& clauses);
+};
+#endif
@@ -0,0 +1,147 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "interpolation.h"
+#include "util.h"
+
+using namespace std;
+
+InterpolatingSolver::InterpolatingSolver(TransitionSystem& t, Stats& stats, bool forest, int verbosity,
+					 const SolverOptions& options)
+  : next_free(0), t(t), stats(stats), itrav(locality, t.max_index + 1, aig), forest(forest), verbosity(verbosity) {
+  proof.reset(attach_proof(s, proof_online, forest ? (ProofTraverser*)&trav : &itrav));
+  configure(s, options);
+
+  // States 0 and 1 belong to A, except for the variables shared with B
+  // These are the output and the next states of all latches in state 1. The latter only occur in B
+  // from bound 2 on, treating them as shared for bound 1 as well amounts to adding tautologies to B
+  for(int i = 0; i < 2; i++) {
+    frame.push_back(next_free);
+    for(int v = 0; v <= t.max_index; v++)
+      new_var(local_a);
+  }
+  for(pair<Lit, Lit> latch : t.latches)
+    locality[var(latch.second) + t.max_index + 1] = shared_ab;
+  locality[var(t.output) + t.max_index + 1] = shared_ab;
+
+  if(verbosity == 2) {
+    cout << "Shared variables: {";
+    for(Var x = 0; x < (Var)locality.size(); x++)
+      if(locality[x] == shared_ab)
+	cout << x << " ";
+    cout << "}" << endl;
+  }
+
+  vec<vec<Lit>> a_partition;
+  t.transition_cnf(a_partition, 0);
+  add_clauses(a_partition, int_f);
+}
+
+void InterpolatingSolver::memory(MemoryStats& m) const {
+  m.itp_clauses = s.clauseBytes();
+  m.itp_watches = s.watchBytes();
+  m.proof = forest ? trav.bytes() : itrav.bytes();
+  m.traverser_clauses = trav.peak_clause_bytes;
+  m.aig = aig.bytes();
+}
+
+Var InterpolatingSolver::new_var(Locality l) {
+  locality.push_back(l);
+  while(s.nVars() <= next_free) { s.newVar(); }
+  return next_free++;
+}
+
+// Translates a literal of the usual frame layout to the variables of this solver
+Lit InterpolatingSolver::frame_literal(Lit x) {
+  int step = var(x) / (t.max_index + 1);
+  return Lit(frame[step] + var(x) % (t.max_index + 1), sign(x));
+}
+
+// Adds clauses to A (partition int_f) or B (int_t)
+void InterpolatingSolver::add_clauses(vec<vec<Lit>>& clauses, Trivial partition) {
+  while(s.nVars() < next_free) { s.newVar(); }
+  if((int)locality.size() < next_free)
+    locality.resize(next_free, local_a);
+  trav.init = itrav.init = partition;
+  for(int i = 0; i < clauses.size(); i++)
+    s.addClause(clauses[i]);
+}
+
+// Adds the frames bound+1..j one at a time
+// The bad disjunction of the previous bound is retired by asserting its activation literal false
+void InterpolatingSolver::extend(int j) {
+  while(bound < j) {
+    bound++;
+    vec<vec<Lit>> b_partition;
+    if(bound > 1) {
+      frame.push_back(next_free);
+      for(int v = 0; v <= t.max_index; v++)
+	new_var(local_b);
+      t.transition_cnf(b_partition, bound - 1);
+    }
+    t.bad_cnf(b_partition, 1, bound);
+    for(int i = 0; i < b_partition.size(); i++)
+      for(int k = 0; k < b_partition[i].size(); k++)
+	b_partition[i][k] = frame_literal(b_partition[i][k]);
+
+    Lit active = Lit(new_var(local_b));
+    b_partition.last().push(~active);
+    if(bad != lit_Undef) {
+      b_partition.push();
+      b_partition.last().push(~bad);
+    }
+    bad = active;
+
+    if(verbosity == 2) { print_cnf(b_partition, "B Partition"); }
+    add_clauses(b_partition, int_t);
+  }
+
+  // Preprocess b partition
+  // Led to substantial improvement for small examples
+  PhaseTimer timer(stats.b_presolve, &s.stats, proof.get());
+  s.solve(vec<Lit>(1, bad));
+}
+
+void InterpolatingSolver::add_definitions(vec<vec<Lit>>& definitions) {
+  add_clauses(definitions, int_f);
+}
+
+bool InterpolatingSolver::solve(const vec<Lit>& labels, Lit& interpolant) {
+  // (~a \/ l_0 \/ ... \/ l_p), retired by asserting ~a afterwards
+  Lit a = Lit(new_var(local_a));
+  vec<vec<Lit>> a_partition;
+  a_partition.push();
+  a_partition.last().push(~a);
+  for(int i = 0; i < labels.size(); i++)
+    a_partition.last().push(labels[i]);
+  if(verbosity == 2) { print_cnf(a_partition, "A Partition"); }
+  add_clauses(a_partition, int_f);
+
+  vec<Lit> assumps;
+  assumps.push(a);
+  assumps.push(bad);
+  bool sat;
+  {
+    PhaseTimer timer(stats.a_solve, &s.stats, proof.get());
+    sat = s.solve(assumps);
+  }
+
+  if(!sat) {
+    PhaseTimer timer(stats.interpolation);
+    // The final conflict is a clause over ~a and ~bad. Resolving it with the units a (in A) and
+    // bad (in B) gives the empty clause without changing the interpolant
+    ClauseId goal = s.okay() ? s.conflict_id : proof->last();
+    proof_clauses = goal + 1;
+    if(forest) {
+      // Only the derivation of the final conflict is turned into a resolution forest
+      core_clauses = trav.finalize(goal);
+      if(verbosity) { cout << "Proof core: " << core_clauses << " of " << goal + 1 << " clauses" << endl; }
+      trav.forest.compute_partial_interpolant(trav.forest.roots[goal], locality, t.max_index + 1, aig);
+      interpolant = trav.forest.nodes[trav.forest.roots[goal]].aig();
+    } else
+      interpolant = itrav.finish(goal);
+  } else if(verbosity == 2)
+    print_model(s);
+
+  trav.init = itrav.init = int_f;
+  s.addUnit(~a);
+  return !sat;
+}
@@ -0,0 +1,67 @@
+#ifndef INTERPOLATION_H
+#define INTERPOLATION_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "traverser.h"
+#include "aig.h"
+#include "util.h"
+#include "stats.h"
+#include <memory>
+
+// Interpolating solver for the queries A /\ B of the interpolation-based checker
+// B = T(1) /\ ... /\ T(j-1) /\ (bad_1 \/ ... \/ bad_j) is extended by one frame per bound j
+// A = T(0) /\ (l_0 \/ ... \/ l_p) where the l_i are labels of formulas built in aig
+// A single solver holds both for the whole run: T(0) and the definitions of aig nodes are
+// added once, the disjunction of the current initial states and the bad disjunction of the
+// current bound are switched with activation literals. Clauses learnt from B and the
+// permanent part of A stay valid, so they are kept
+// States 0 and 1 use their usual variables, the variables of every later state are
+// allocated as a block after the labels existing at the time
+// The pre-solve of B, the solves of A and the interpolation are timed in stats, with the proof
+// logged by the first two
+class InterpolatingSolver {
+public:
+  InterpolatingSolver(TransitionSystem& t, Stats& stats, bool forest = false, int verbosity = 0,
+		      const SolverOptions& options = SolverOptions());
+
+  // Initial states and interpolants, over the variables of state 0
+  AigManager aig;
+  // Next variable that is not used by any state, label or activation literal
+  Var next_free;
+
+  // Extends B to bound j
+  void extend(int j);
+  // Adds the definitions of newly encoded aig nodes to A
+  void add_definitions(vec<vec<Lit>>& definitions);
+  // Solves A /\ B with the disjunction of labels as initial states
+  // Returns false if satisfiable, otherwise interpolant is set to the interpolant in aig
+  bool solve(const vec<Lit>& labels, Lit& interpolant);
+  // Clauses of the proof up to the last refutation and of its core (only known with forest, -1 otherwise)
+  int proof_clauses = 0;
+  int core_clauses = -1;
+  // Sets the bytes held by the solver, the proof and the aig in m
+  void memory(MemoryStats& m) const;
+
+private:
+  TransitionSystem& t;
+  Stats& stats;
+  Solver s;
+  Traverser trav;
+  InterpolatingTraverser itrav;
+  unique_ptr<Proof> proof;
+  bool forest;
+  int verbosity;
+  // Locality of every variable
+  vector<char> locality;
+  // First variable of every state
+  vector<Var> frame;
+  // Current bound and the activation literal of its bad disjunction
+  int bound = 0;
+  Lit bad = lit_Undef;
+
+  Var new_var(Locality l);
+  Lit frame_literal(Lit x);
+  void add_clauses(vec<vec<Lit>>& clauses, Trivial partition);
+};
+#endif
@@ -0,0 +1,102 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "kinduction.h"
+#include "util.h"
+#include <map>
+
+using namespace std;
+
+KInduction::KInduction(TransitionSystem& t, int verbosity, const SolverOptions& options)
+  : t(t), verbosity(verbosity), base(t, verbosity, proof_none, options) {
+  configure(step, options);
+  // The property is assumed in all but the last state, so the circuit is needed in both polarities
+  new_frame();
+  vec<vec<Lit>> clauses;
+  t.circuit_cnf(clauses, 0);
+  add_step(clauses);
+}
+
+void KInduction::new_frame() {
+  frame.push_back(next_free);
+  next_free += t.max_index + 1;
+  while(step.nVars() < next_free) { step.newVar(); }
+}
+
+// Translates a literal of the usual frame layout to the variables of the step solver
+Lit KInduction::step_literal(Lit x) {
+  int i = var(x) / (t.max_index + 1);
+  return Lit(frame[i] + var(x) % (t.max_index + 1), sign(x));
+}
+
+void KInduction::add_step(vec<vec<Lit>>& clauses) {
+  for(int i = 0; i < clauses.size(); i++) {
+    for(int j = 0; j < clauses[i].size(); j++)
+      clauses[i][j] = step_literal(clauses[i][j]);
+    step.addClause(clauses[i]);
+  }
+}
+
+// Adds the constraint that states i and j differ in some latch
+// d_l -> (l_i xor l_j) for a fresh d_l per latch, and the disjunction of all d_l
+void KInduction::differ(int i, int j) {
+  vec<Lit> clause;
+  for(pair<Lit, Lit> latch : t.latches) {
+    Lit a = step_literal(shift_literal(latch.first, i * (t.max_index + 1)));
+    Lit b = step_literal(shift_literal(latch.first, j * (t.max_index + 1)));
+    Lit d = Lit(next_free++);
+    while(step.nVars() < next_free) { step.newVar(); }
+    step.addTernary(~d, a, b);
+    step.addTernary(~d, ~a, ~b);
+    clause.push(d);
+  }
+  step.addClause(clause);
+  simple_paths++;
+}
+
+// Adds a simple path constraint for every state of the step model that equals an earlier one
+// Returns false if all states are distinct, i.e. the step case fails on a simple path
+bool KInduction::add_simple_paths() {
+  map<vector<bool>, int> seen;
+  bool added = false;
+  for(int i = 0; i < (int)frame.size(); i++) {
+    vector<bool> state;
+    for(pair<Lit, Lit> latch : t.latches)
+      state.push_back(step.model[frame[i] + var(latch.first)] == l_True);
+    auto it = seen.emplace(state, i);
+    if(!it.second) {
+      differ(it.first->second, i);
+      added = true;
+    }
+  }
+  return added;
+}
+
+// For k = 0, 1, ...: the base case checks bound k, the step case a path of k+2 states
+// The property of state k is asserted for good before state k+1 is checked, so nothing is retracted
+bool KInduction::check() {
+  for(k = 0;; k++) {
+    if(!base.check(k))
+      return false;
+    if(base.proven())
+      return true;
+
+    new_frame();
+    vec<vec<Lit>> clauses;
+    t.transition_cnf(clauses, k);
+    add_step(clauses);
+    step.addUnit(~step_literal(shift_literal(t.output, k * (t.max_index + 1))));
+
+    vec<Lit> assumps;
+    assumps.push(step_literal(shift_literal(t.output, (k + 1) * (t.max_index + 1))));
+    bool violated = step.solve(assumps);
+    while(violated && add_simple_paths())
+      violated = step.solve(assumps);
+    if(!violated)
+      return true;
+
+    if(verbosity) {
+      cout << "k-induction: step case fails for k=" << k << ", " << simple_paths
+	   << " simple path constraints" << endl;
+    }
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef KINDUCTION_H
+#define KINDUCTION_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "bmc.h"
+#include "util.h"
+#include <vector>
+
+using namespace std;
+
+// k-induction
+// The base case is the incremental bounded model checker, the step case a second solver that
+// unrolls k+1 steps from an unconstrained state, assumes the property in the first k+1 states
+// and asks for a violation in the last one. Both are extended by one frame per k
+// Simple path constraints are only added for states that turn out to be equal in a model of the
+// step case, so shallow invariants are proven without any of them
+// Frames of the step case are allocated as blocks, the auxiliary variables of the constraints in between
+class KInduction {
+public:
+  KInduction(TransitionSystem& t, int verbosity = 0, const SolverOptions& options = SolverOptions());
+  // Returns true iff the property holds in every reachable state
+  bool check();
+  // Current k
+  int depth() { return k; }
+  // Number of simple path constraints added so far
+  int simple_paths = 0;
+
+private:
+  TransitionSystem& t;
+  int verbosity;
+  IncrementalBMC base;
+  Solver step;
+  // First variable of every state of the step case
+  vector<Var> frame;
+  Var next_free = 0;
+  int k = 0;
+
+  void new_frame();
+  Lit step_literal(Lit x);
+  void add_step(vec<vec<Lit>>& clauses);
+  void differ(int i, int j);
+  bool add_simple_paths();
+};
+#endif
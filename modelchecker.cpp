@@ -1,224 +1,506 @@
 #include <iostream>
 #include <fstream>
 #include <set>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <getopt.h>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
 #include "transition_system.h"
 #include "traverser.h"
+#include "bmc.h"
+#include "interpolation.h"
+#include "pdr.h"
+#include "kinduction.h"
+#include "multiproperty.h"
+#include "batch.h"
 #include "MiniSat-p_v1.14/Proof.h"
 #include "MiniSat-p_v1.14/Solver.h"
 #include "MiniSat-p_v1.14/File.h"
 #include "util.h"
+#include "stats.h"
 
 using namespace std;
 
 // Bounded model checking procedure
 // Return true iff property is not violated up to bound k
-bool bmc(TransitionSystem t, int k, int verbosity) {
-  Solver s;
-  s.proof = new Proof();
-  vec<vec<Lit>> clauses;
-
-  // Populate "clauses" by initial state, k transitions and bad property 
-  
-  t.initial_cnf(clauses);
-  t.bad_cnf(clauses, 0, k);
-
-  for(int j = 0; j < k; j++)
-    t.transition_cnf(clauses ,j);
-
-  // Add clauses and check for satisfiability
-  while( (k+1) * (t.max_index + 1) > s.nVars()) { s.newVar(); }
-  
-  for(int i = 0; i < clauses.size(); i++)
-    s.addClause(clauses[i]);
-
-  s.solve();
-  
-  if(s.okay()) {
-    if(verbosity == 2) { print_model(s); }
-    return false;
+bool bmc(TransitionSystem& t, int k, int verbosity, Stats& stats) {
+  IncrementalBMC b(t, verbosity);
+  bool safe = true;
+  // One bound at a time, so the memory limit is checked in between
+  for(int i = 0; i <= k && safe && !b.proven(); i++) {
+    {
+      PhaseTimer timer(stats.bmc, &b.solver_stats());
+      safe = b.check(i);
+    }
+    MemoryStats m;
+    b.memory(m);
+    stats.account(m);
   }
-  return true;
+  return safe;
 }
 
 
 
-bool imc(TransitionSystem& t, int inner_bound, int outer_bound, int verbosity) {
+// With forest the interpolant is computed from the stored proof core instead of while solving
+// If sweep is positive, every interpolant is SAT swept for at most that many seconds
+bool imc(TransitionSystem& t, int inner_bound, int outer_bound, bool forest, double sweep, int verbosity,
+	 const SolverOptions& options, Stats& stats) {
   if(verbosity) { cout << "Running initial bmc" << endl; }
+  // A single incremental bmc instance is extended by one frame per outer iteration
+  IncrementalBMC b(t, verbosity, proof_none, options);
+
   // Check if there is an initial state that violates property
-  if(!bmc(t, 0, verbosity))
+  bool safe;
+  {
+    PhaseTimer timer(stats.bmc, &b.solver_stats());
+    safe = b.check(0);
+  }
+  if(!safe)
     return false;
   
+  // One interpolating solver is kept for the whole run, B is extended by one frame per outer iteration
+  // By default the interpolant is computed while solving, with forest the core of the proof is stored first
+  InterpolatingSolver itp_solver(t, stats, forest, verbosity, options);
+  // Initial states and interpolants are built in one structurally hashed aig over the variables of state 0
+  // Every node is tseitinized once and its definition is added to both solvers
+  AigManager& aig = itp_solver.aig;
+  // This is the first variable that can be used for labels for tseitinization
+  Var& next_free = itp_solver.next_free;
+
+  // Containment checks (Interpolant => INIT) share one solver as well
+  // It holds the definitions of all encoded nodes and, under the activation literal of the
+  // current outer iteration, ~l for every label l of INIT. So each check only adds the new
+  // definitions and assumes the new interpolant
+  // The containment check never interpolates, it does not need a proof
+  Solver fix;
+  attach_proof(fix, proof_none);
+  configure(fix, options);
+  auto add_fix = [&](vec<vec<Lit>>& clauses) {
+    while(fix.nVars() < next_free) { fix.newVar(); }
+    for(int i = 0; i < clauses.size(); i++)
+      fix.addClause(clauses[i]);
+  };
+  // Adds ~x to the initial states of the current outer iteration
+  auto exclude = [&](Lit current, Lit x) {
+    vec<Lit> clause;
+    clause.push(~current);
+    clause.push(~x);
+    fix.addClause(clause);
+  };
+  // Takes a memory snapshot of all solvers, the proof and the aig
+  // Throws MemoryLimit if the limit of the run is exceeded
+  auto account = [&]() {
+    MemoryStats m;
+    b.memory(m);
+    itp_solver.memory(m);
+    m.fixpoint_clauses = fix.clauseBytes();
+    m.fixpoint_watches = fix.watchBytes();
+    stats.account(m);
+  };
+
   // Unroll B partition outer_bound many times
   // If unspecified continue until either FAIL/OK
   for(int j=1; (outer_bound + 1) - j != 0;j++) {
     if(verbosity) cout << "Outer Loop: j=" << j << "\n Running bmc for k=" << j << endl;
     
     // First do a bmc run
-    if(!bmc(t, j, verbosity))
-      return false;
-    
-    // Construct B partition
-    vec<vec<Lit>> b_partition;
-    t.bad_cnf(b_partition, 1, j);
-    for(int i=1; i<j; i++)
-      t.transition_cnf(b_partition, i);
-
-    // Compute set of variables shared between partitions
-    set<Var> shared;
-    Var lower_b = 2 * (t.max_index + 1);
-    Var upper_b = (j+1) * (t.max_index + 1) - 1;
-
-    if(j > 1)
-      for(pair<Lit, Lit> latch : t.latches)
-	shared.insert(var(latch.second) + (t.max_index + 1));
-      
-    shared.insert(var(t.output) + t.max_index + 1);
-
-    if(verbosity == 2) {
-      cout << "Shared variables: {";
-      for(Var x : shared)
-	cout << x << " ";
-      cout << "}" << endl;
-
-      print_cnf(b_partition, "B Partition");
+    {
+      PhaseTimer timer(stats.bmc, &b.solver_stats());
+      safe = b.check(j);
     }
+    account();
+    if(!safe)
+      return false;
     
-    // This is the first variable that can be used for labels for tseitinization
-    Var next_free = (j+1) * (t.max_index+1);
+    itp_solver.extend(j);
 
     // Initialize first state with initial state of the transition system
     // The labels clause keeps track of the top level labels of tseitinized formulas
     vec<vec<Lit>> init;
     vec<Lit> labels;
+    labels.push(aig.encode(t.initial_aig(aig), &next_free, init));
+    itp_solver.add_definitions(init);
 
-    t.initial_tseitin(init, &next_free);
-    labels.push(Lit(next_free - 1));
+    // Activation literal of this outer iteration in the containment solver
+    Lit current = Lit(next_free++);
+    add_fix(init);
+    exclude(current, labels[0]);
 
     // Run loop inner_bound many times
     // Continue until spurious counterexample/OK if no bound specified
     for(int p = 0; inner_bound - p != 0; p++) {
       if(verbosity) { cout << "Inner iteration: " << p << endl; }
 
-      Solver s;
-      Traverser trav;
-      s.proof = new Proof(trav);
-      while( next_free > s.nVars()) { s.newVar(); }
-
-      // Initialize b_partition's interpolants to true
-      trav.init = int_t;
-      // Add B partiton to Solver
-      for(int i=0; i < b_partition.size(); i++)
-        s.addClause(b_partition[i]);
-
-      // Preprocess b partition
-      // Led to substantial improvement for small examples
-      // See if this still holds true when improving interpolation
-      s.solve();
-
-      // Construct A partition    
-      vec<vec<Lit>> a_partition;
-      for(int i=0; i<init.size(); i++) {
-        a_partition.push();
-        init[i].copyTo(a_partition.last());
-      }
-      t.transition_cnf(a_partition, 0);
-      a_partition.push(); labels.copyTo(a_partition.last());
-
-      // Initialize a_partition's interpolants to true
-      trav.init = int_f;
-      // Add A partition to solver
-      for(int i=0; i < a_partition.size(); i++)
-        s.addClause(a_partition[i]);
-
-      if(verbosity == 2) { print_cnf(a_partition, "A Partition"); }
-
-      s.solve();
+      // Compute Interpolant I over the variables of state 0, only its new nodes are tseitinized
+      Lit itp;
+      uint64 conflicts = stats.a_solve.conflicts;
+      bool unsat = itp_solver.solve(labels, itp);
+      stats.iterations.emplace_back();
+      IterationStats& iteration = stats.iterations.back();
+      iteration.outer = j;
+      iteration.inner = p;
+      iteration.conflicts = stats.a_solve.conflicts - conflicts;
+      iteration.proof_clauses = itp_solver.proof_clauses;
+      iteration.core_clauses = itp_solver.core_clauses;
+      iteration.init_size = labels.size();
+      iteration.next_free = next_free;
+      account();
 
       // Check for spurious counterexample
-      if(s.okay()) {
+      if(!unsat) {
 	if(verbosity) { cout << "Spurious counterexample found" << endl; }
-	if(verbosity == 2) { print_model(s); }
-	
 	break;
       }
-      
-      // Compute Interpolant I
-      if(verbosity) { cout << "Computing interpolant" << endl; } 
-      shared_ptr<Node> proof_root = trav.forest.roots[trav.forest.roots.size()-1];
+
+      if(sweep > 0) {
+	int before = aig.cone_size(itp);
+	double seconds = stats.sweep.seconds;
+	{
+	  PhaseTimer timer(stats.sweep);
+	  itp = aig.sweep(itp, sweep, options);
+	}
+	if(verbosity) {
+	  cout << "Sweeping: " << before << " -> " << aig.cone_size(itp) << " new aig nodes in "
+	       << (stats.sweep.seconds - seconds) * 1000 << " ms" << endl;
+	}
+      }
+
+      // The fixpoint check includes encoding the interpolant, which A needs as well
+      PhaseTimer timer(stats.fixpoint, &fix.stats);
       vec<vec<Lit>> interpolant;
-      trav.forest.compute_partial_interpolant(trav.forest.roots[trav.forest.roots.size()-1], &shared, lower_b, upper_b, trav.forest.roots.size()-1, &next_free, interpolant);
-      if(verbosity) { cout << "Done, size: " << interpolant.size() << " clauses" << endl; }
+      int encoded = aig.encoded;
+      Lit root = aig.encode(itp, &next_free, interpolant);
+      iteration.interpolant_clauses = interpolant.size();
+      iteration.interpolant_nodes = aig.encoded - encoded;
+      iteration.next_free = next_free;
+      if(verbosity) {
+	cout << "Done, size: " << interpolant.size() << " clauses, " << aig.encoded - encoded << " new of "
+	     << aig.size() << " aig nodes" << endl;
+      }
       if(verbosity == 2) { print_cnf(interpolant, "Interpolant"); }
-      
+      itp_solver.add_definitions(interpolant);
+
       // Check if fixpoint is reached (Interpolant => INIT)
       // For this check satisfiability (Interpolant & ~INIT)
-      Solver fix;
-      fix.proof = new Proof();
-      while(fix.nVars() < next_free) { fix.newVar(); }
+      // Add the new definitions, its older nodes are already defined
+      add_fix(interpolant);
+      vec<Lit> assumps;
+      assumps.push(current);
+      assumps.push(root);
+      bool contained = !fix.solve(assumps);
+      account();
+
+      if(contained)
+	return true;
       
-      // Add ~INIT
-      for(int i = 0; i < init.size(); i++)
-	fix.addClause(init[i]);
+      // Add interpolant to new initial state, it is excluded from further containment checks
+      labels.push(root);
+      exclude(current, root);
+    }
 
-      for(int i = 0; i < labels.size(); i++)
-	fix.addClause(vec<Lit>(1, ~labels[i]));
+    // The next outer iteration starts over from the initial states
+    fix.addUnit(~current);
+  }
+  // This is only reachable if outer_bound was specified
+  return true;
+}
 
-      // Note that the interpolant cannot be T/F as initial bmc run passed and we have a bad property
-      // Shift interpolant before adding to solver
-      for(int i = 0; i < interpolant.size(); i++)
-	for(int k = 0; k < interpolant[i].size(); k++)
-	  if(shared.count(var(interpolant[i][k])))
-	    interpolant[i][k] = Lit(var(interpolant[i][k]) - t.max_index - 1, sign(interpolant[i][k]));
+// Property directed reachability
+// Return true iff property holds in every reachable state
+bool pdr(TransitionSystem& t, int verbosity, const SolverOptions& options) {
+  PDR p(t, verbosity, options);
+  bool safe = p.check();
+  if(verbosity) { cout << "PDR finished at depth " << p.depth() << endl; }
+  return safe;
+}
 
-      if(shared.count(var(proof_root->label)))
-	proof_root->label = Lit(var(proof_root->label) - t.max_index - 1, sign(proof_root->label));
+// k-induction
+// Return true iff property holds in every reachable state
+bool kinduction(TransitionSystem& t, int verbosity, const SolverOptions& options) {
+  KInduction kind(t, verbosity, options);
+  bool safe = kind.check();
+  if(verbosity) {
+    cout << "k-induction finished at k=" << kind.depth() << " with " << kind.simple_paths
+	 << " simple path constraints" << endl;
+  }
+  return safe;
+}
 
-      // Add interpolant
-      for(int i = 0; i < interpolant.size(); i++)
-	fix.addClause(interpolant[i]);
+// Checks every property on one shared unrolling, up to bound k unless it is -1
+// Returns the verdict of every property on its own line, outputs are named o<i> and bad properties b<i>
+string multi(TransitionSystem& t, int k, int verbosity) {
+  MultiProperty m(t, verbosity);
+  m.check(k);
+  stringstream verdicts;
+  for(int i = 0; i < (int)t.properties.size(); i++) {
+    if(i > 0) { verdicts << endl; }
+    verdicts << (i < t.nr_outputs ? "o" + to_string(i) : "b" + to_string(i - t.nr_outputs)) << ": "
+	     << (m.status[i] == status_falsified ? "FAIL" : "OK");
+    if(verbosity && m.status[i] != status_unknown) { verdicts << " (k=" << m.decided_at[i] << ")"; }
+  }
+  return verdicts.str();
+}
 
-      fix.addClause(vec<Lit>(1,proof_root->label));
+// Runs n engines on separate threads over the shared transition system, which is only read
+// Engine 0 is imc with the given options, engine 1 is bmc with increasing bounds, engine 2 is pdr and
+// engine 3 is k-induction. The bmc engine only falsifies, it runs until it finds a counterexample
+// or another engine decides
+// The others are imc with their own random seed, every third one also toggles sweeping or bounds the inner loop
+// The first engine to finish decides, the others are interrupted at their next conflict
+// Engines run silently, outer_bound is kept for all imc engines as a bounded run is no proof
+// Only the imc and bmc engines fill in their statistics and account their memory
+bool portfolio(TransitionSystem& t, int n, int inner_bound, int outer_bound, bool forest, double sweep,
+	       int verbosity, Stats& stats) {
+  struct Engine {
+    string name;
+    SolverOptions options;
+    function<bool(const SolverOptions&, Stats&)> run;
+  };
+  atomic<bool> stop(false);
+  vector<Engine> engines(n);
+  for(int i = 0; i < n; i++) {
+    Engine& e = engines[i];
+    e.options.interrupt = &stop;
+    if(i == 1) {
+      e.name = "bmc";
+      e.run = [&t](const SolverOptions& options, Stats& stats) {
+	IncrementalBMC b(t, 0, proof_none, options);
+	for(int k = 0; ; k++) {
+	  if(*options.interrupt) { throw Interrupted(); }
+	  {
+	    PhaseTimer timer(stats.bmc, &b.solver_stats());
+	    if(!b.check(k))
+	      return false;
+	  }
+	  MemoryStats m;
+	  b.memory(m);
+	  stats.account(m);
+	}
+      };
+      continue;
+    }
+    if(i == 2) {
+      e.name = "pdr";
+      e.run = [&t](const SolverOptions& options, Stats&) { return pdr(t, 0, options); };
+      continue;
+    }
+    if(i == 3) {
+      e.name = "k-induction";
+      e.run = [&t](const SolverOptions& options, Stats&) { return kinduction(t, 0, options); };
+      continue;
+    }
+    int inner = inner_bound;
+    double sw = sweep;
+    e.name = "imc";
+    if(i >= 4) {
+      e.options.seed += i;
+      if(i % 3 == 1)
+	sw = sweep > 0 ? 0 : 1;
+      else if(i % 3 == 2)
+	inner = 1 << (i / 3);
+      e.name += " seed " + to_string((long)e.options.seed);
+    }
+    if(inner != -1) { e.name += " -a " + to_string(inner); }
+    if(sw > 0) { e.name += " -s " + to_string(sw); }
+    e.run = [&t, inner, outer_bound, forest, sw](const SolverOptions& options, Stats& stats) {
+      return imc(t, inner, outer_bound, forest, sw, 0, options, stats);
+    };
+  }
 
-      fix.solve();
+  auto start = chrono::steady_clock::now();
+  int winner = -1;
+  bool safe = false;
+  // Every engine starts from the statistics of parsing and preprocessing and gets an equal share of the memory limit
+  vector<Stats> engine_stats(n, stats);
+  for(Stats& s : engine_stats)
+    s.memory_limit /= n;
+  // Error of every engine that failed other than by running out of memory, empty for the others
+  vector<string> errors(n);
+  vector<thread> threads;
+  for(int i = 0; i < n; i++) {
+    threads.emplace_back([&, i] {
+	try {
+	  bool result = engines[i].run(engines[i].options, engine_stats[i]);
+	  if(!stop.exchange(true)) {
+	    winner = i;
+	    safe = result;
+	  }
+	}
+	catch(const Interrupted&) { }
+	// An engine out of memory or failing otherwise gives up, the others go on
+	catch(const bad_alloc&) { }
+	catch(const exception& e) { errors[i] = e.what(); }
+      });
+  }
+  for(thread& th : threads)
+    th.join();
+
+  if(winner < 0) {
+    // No engine decided. The first error is reported, if every engine ran out of memory
+    // the breakdown of the main engine is
+    stats = engine_stats[0];
+    for(int i = 0; i < n; i++)
+      if(!errors[i].empty())
+	throw runtime_error(engines[i].name + ": " + errors[i]);
+    throw MemoryLimit();
+  }
 
-      if(!fix.okay())
-	return true;
-      
-      // Add interpolant to new initial state
-      for(int i = 0; i < interpolant.size(); i++) {
-	init.push();
-	interpolant[i].copyTo(init.last());
-      }
-      labels.push(Lit(proof_root->label));
+  if(verbosity) {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "Portfolio: " << engines[winner].name << " decided after " << elapsed.count() * 1000
+	 << " ms (" << n << " engines)" << endl;
+    for(int i = 0; i < n; i++)
+      if(!errors[i].empty())
+	cout << "Portfolio: " << engines[i].name << " failed: " << errors[i] << endl;
+  }
+  stats = engine_stats[winner];
+  return safe;
+}
+
+// Command line options of a run
+struct Options {
+  int k = -1;
+  int outer_bound = -1;
+  int inner_bound = -1;
+  int verbosity = 0;
+  bool forest = false;
+  double sweep = 0;
+  int engines = 0;
+  // Unbounded engine of a run without portfolio, imc if empty
+  string engine;
+  // Format of the statistics printed after the verdict, none if empty
+  string stats;
+};
+
+// Parses, simplifies and checks the transition system in file
+// Throws ParseError if the file cannot be parsed, bad_alloc if memory runs out and other exceptions if an engine fails
+// Returns the verdict (one line per property if there are several)
+string check(const string& file, const Options& o, Stats& stats) {
+  TransitionSystem t;
+  size_t size;
+  {
+    PhaseTimer timer(stats.parse);
+    size = t.parse(file);
+  }
+  if(o.verbosity) {
+    cout << "Parsed " << size << " bytes in " << stats.parse.seconds * 1000 << " ms ("
+	 << size / double(1 << 20) / stats.parse.seconds << " MB/s)" << endl;
+  }
+
+  // Normalize the AIG and drop everything that cannot influence the output before any cnf is produced
+  {
+    PhaseTimer timer(stats.preprocess);
+    int inputs = t.nr_inputs, latches = t.nr_latches, gates = t.nr_gates;
+    t.simplify();
+    if(o.verbosity) {
+      cout << "Simplification: latches " << latches << " -> " << t.nr_latches
+	   << ", gates " << gates << " -> " << t.nr_gates << endl;
+    }
+    latches = t.nr_latches, gates = t.nr_gates;
+    t.reduce_coi();
+    if(o.verbosity) {
+      cout << "Cone of influence: inputs " << inputs << " -> " << t.nr_inputs << ", latches " << latches
+	   << " -> " << t.nr_latches << ", gates " << gates << " -> " << t.nr_gates << endl;
     }
   }
-  // This is only reachable if outer_bound was specified
-  return true;
+
+  bool safe;
+  if(t.properties.size() > 1) {
+    if(o.verbosity) { cout << "Checking " << t.properties.size() << " properties with k-induction" << endl; }
+    return multi(t, o.k, o.verbosity);
+  } else if(o.k != -1) {
+    safe = bmc(t, o.k, o.verbosity, stats);
+  } else if(o.engines > 0) {
+    safe = portfolio(t, o.engines, o.inner_bound, o.outer_bound, o.forest, o.sweep, o.verbosity, stats);
+  } else if(o.engine == "pdr") {
+    safe = pdr(t, o.verbosity, SolverOptions());
+  } else if(o.engine == "kind") {
+    safe = kinduction(t, o.verbosity, SolverOptions());
+  } else {
+    safe = imc(t, o.inner_bound, o.outer_bound, o.forest, o.sweep, o.verbosity, SolverOptions(), stats);
+  }
+  return safe ? "OK" : "FAIL";
 }
 
 int main(int argc, char* argv[]) {
   int opt;
-  int outer_loop_bound = -1;
-  int inner_loop_bound = -1;
-  int verbosity = 0;
+  Options o;
+  string batch;
+  BatchLimits limits;
+  limits.jobs = std::max(1u, thread::hardware_concurrency());
+  limits.time = 300;
+  static struct option long_options[] = {
+    {"portfolio", required_argument, NULL, 'p'},
+    {"batch", required_argument, NULL, 'B'},
+    {"jobs", required_argument, NULL, 'j'},
+    {"time-limit", required_argument, NULL, 't'},
+    {"mem-limit", required_argument, NULL, 'm'},
+    {"stats", required_argument, NULL, 'S'},
+    {NULL, 0, NULL, 0}
+  };
 
   // Parse optional parameters
-  while ((opt = getopt(argc, argv, "b:a:vV")) != -1) {
+  while ((opt = getopt_long(argc, argv, "b:a:e:fs:vV", long_options, NULL)) != -1) {
     switch (opt)
       {
-      case 'o':
-	if(verbosity) cout << "B partition will be expanded at most " << optarg << " many times" << endl;
-	outer_loop_bound = stoi(optarg);
+      case 'b':
+	if(o.verbosity) cout << "B partition will be expanded at most " << optarg << " many times" << endl;
+	o.outer_bound = stoi(optarg);
 	break;
       case 'a':
-	if(verbosity) cout << "A partition will be expanded at most " << optarg << " many times" << endl;
-	inner_loop_bound = stoi(optarg);
+	if(o.verbosity) cout << "A partition will be expanded at most " << optarg << " many times" << endl;
+	o.inner_bound = stoi(optarg);
+	break;
+      case 'e':
+	o.engine = optarg;
+	if(o.engine != "imc" && o.engine != "pdr" && o.engine != "kind") {
+	  cout << "Unknown engine: " << o.engine << endl;
+	  cout << "Aborting." << endl;
+	  return 1;
+	}
+	break;
+      case 'f':
+	o.forest = true;
+	break;
+      case 's':
+	o.sweep = stod(optarg);
+	break;
+      case 'p':
+	o.engines = stoi(optarg);
+	if(o.engines < 1) {
+	  cout << "Portfolio needs at least one engine" << endl;
+	  cout << "Aborting." << endl;
+	  return 1;
+	}
+	break;
+      case 'B':
+	batch = optarg;
+	break;
+      case 'j':
+	limits.jobs = std::max(1, stoi(optarg));
+	break;
+      case 't':
+	limits.time = stod(optarg);
+	break;
+      case 'm':
+	limits.memory = stoi(optarg);
+	break;
+      case 'S':
+	o.stats = optarg;
+	if(o.stats != "json" && o.stats != "text") {
+	  cout << "Unknown statistics format: " << o.stats << endl;
+	  cout << "Aborting." << endl;
+	  return 1;
+	}
 	break;
       case 'v':
-	verbosity = 1;
+	o.verbosity = 1;
 	break;
       case 'V':
-        verbosity = 2;
+        o.verbosity = 2;
 	break;
       case '?':
         cout << "Unknown option: " << optarg << endl;
@@ -232,30 +514,100 @@ int main(int argc, char* argv[]) {
 	break;
    }
   }
-  int k = -1;
+  if(o.engines > 0 && !o.engine.empty()) {
+    cout << "The portfolio runs a fixed set of engines, -e cannot be combined with --portfolio" << endl;
+    cout << "Aborting." << endl;
+    return 1;
+  }
   // Parse non-option arguments
-  if (argc - optind == 2) {
-    // Expecting first argument k, second argument file_name for bounded model checking
-    k = stoi(argv[optind++]);
-  } else if (argc - optind != 1) {
+  // Expecting an optional bound k for bounded model checking and, unless in batch mode, the file name
+  int files = batch.empty() ? 1 : 0;
+  if (argc - optind == files + 1) {
+    o.k = stoi(argv[optind++]);
+  } else if (argc - optind != files) {
     cout << "Cannot parse input" << endl;
     cout << "Aborting." << endl;
     return 1;
   }
 
-  TransitionSystem t;
-  t.parse(argv[optind]);
+  if(!batch.empty()) {
+    // Workers run silently, their counters are the microseconds of every phase
+    // and the conflicts of the phases that run a solver
+    o.verbosity = 0;
+    o.stats.clear();
+    vector<string> solver_phases = {"bmc", "b_presolve", "a_solve", "fixpoint"};
+    vector<string> counters;
+    for(auto& p : Stats().phases())
+      counters.push_back(p.first + "_us");
+    for(const string& p : solver_phases)
+      counters.push_back(p + "_conflicts");
+    BatchCheck check_file = [&o, &limits, &solver_phases](const string& file, vector<uint64>& c) {
+      Stats stats;
+      stats.memory_limit = (uint64)limits.memory << 20;
+      string verdict = check(file, o, stats);
+      replace(verdict.begin(), verdict.end(), '\n', ' ');
+      size_t i = 0;
+      for(auto& p : stats.phases())
+	c[i++] = p.second->seconds * 1e6;
+      for(auto& p : stats.phases())
+	if(find(solver_phases.begin(), solver_phases.end(), p.first) != solver_phases.end())
+	  c[i++] = p.second->conflicts;
+      return verdict;
+    };
+    try {
+      run_batch(batch, limits, counters, check_file, cout);
+    }
+    catch(const exception& e) {
+      cout << "Error in batch run: " << e.what() << endl;
+      cout << "Aborting." << endl;
+      return 1;
+    }
+    return 0;
+  }
 
-  if(k != -1) {
-    cout << (bmc(t,k, verbosity)?"OK":"FAIL") << endl;
-  } else {
-    cout << (imc(t,inner_loop_bound, outer_loop_bound, verbosity)?"OK":"FAIL") << endl;
+  // The accounted memory is checked against the limit between solver calls, the address space limit
+  // catches everything else. Either way the run ends with bad_alloc
+  Stats stats;
+  if(limits.memory > 0) {
+    stats.memory_limit = (uint64)limits.memory << 20;
+    limit_memory(limits.memory);
+  }
+  string verdict;
+  auto start = chrono::steady_clock::now();
+  try {
+    verdict = check(argv[optind], o, stats);
+    cout << verdict << endl;
+  }
+  catch(const MemoryLimit&) {
+    verdict = "MEMOUT";
+    cout << verdict << endl;
+    cout << "Memory limit of " << limits.memory << " MB exceeded" << endl;
+    if(o.stats.empty() && !o.verbosity) { stats.print_memory(cout); }
   }
+  catch(const bad_alloc&) {
+    verdict = "MEMOUT";
+    cout << verdict << endl;
+    if(limits.memory > 0)
+      cout << "Address space limit of " << limits.memory << " MB exceeded" << endl;
+    else
+      cout << "Out of memory" << endl;
+    if(o.stats.empty() && !o.verbosity) { stats.print_memory(cout); }
+  }
+  catch(const ParseError& e) {
+    cout << "Error while parsing " << argv[optind] << ": " << e.what() << endl;
+    cout << "Aborting." << endl;
+    return 1;
+  }
+  catch(const exception& e) {
+    cout << "Error while checking " << argv[optind] << ": " << e.what() << endl;
+    cout << "Aborting." << endl;
+    return 1;
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  if(o.stats == "json")
+    stats.print_json(cout, verdict, elapsed.count());
+  else if(o.stats == "text" || o.verbosity)
+    stats.print(cout);
   
   return 0;
 }
-
-
-
-
-
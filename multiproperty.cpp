@@ -0,0 +1,168 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "multiproperty.h"
+#include "util.h"
+#include <map>
+
+using namespace std;
+
+MultiProperty::MultiProperty(TransitionSystem& t, int verbosity, const SolverOptions& options)
+  : status(t.properties.size(), status_unknown), decided_at(t.properties.size(), -1), t(t), verbosity(verbosity) {
+  configure(s, options);
+  init = Lit(new_var());
+  for(size_t p = 0; p < t.properties.size(); p++)
+    hold.push_back(Lit(new_var()));
+  new_frame();
+}
+
+Var MultiProperty::new_var() {
+  while(s.nVars() <= next_free) { s.newVar(); }
+  return next_free++;
+}
+
+// Adds the next state. State 0 gets the circuit and the initial states under their activation
+// literal, every later state the transition from its predecessor
+// Properties are assumed negatively, so the circuit is needed in both polarities
+void MultiProperty::new_frame() {
+  int i = frame.size();
+  frame.push_back(next_free);
+  next_free += t.max_index + 1;
+  while(s.nVars() < next_free) { s.newVar(); }
+
+  vec<vec<Lit>> clauses;
+  if(i == 0)
+    t.circuit_cnf(clauses, 0);
+  else
+    t.transition_cnf(clauses, i - 1);
+  add_clauses(clauses, lit_Undef);
+  if(i == 0) {
+    clauses.clear();
+    t.initial_latches_cnf(clauses);
+    add_clauses(clauses, init);
+  }
+
+  for(size_t p = 0; p < t.properties.size(); p++)
+    if(status[p] == status_proven)
+      s.addUnit(~bad(p, i));
+}
+
+// Translates a literal of the usual frame layout to the variables of the solver
+Lit MultiProperty::frame_literal(Lit x) {
+  int i = var(x) / (t.max_index + 1);
+  return Lit(frame[i] + var(x) % (t.max_index + 1), sign(x));
+}
+
+// Bad literal of property p in state i
+Lit MultiProperty::bad(int p, int i) {
+  return frame_literal(shift_literal(t.properties[p], i * (t.max_index + 1)));
+}
+
+// Adds clauses over the usual frame layout, guarded by activation literal a unless it is lit_Undef
+void MultiProperty::add_clauses(vec<vec<Lit>>& clauses, Lit a) {
+  for(int i = 0; i < clauses.size(); i++) {
+    for(int j = 0; j < clauses[i].size(); j++)
+      clauses[i][j] = frame_literal(clauses[i][j]);
+    if(a != lit_Undef)
+      clauses[i].push(~a);
+    s.addClause(clauses[i]);
+  }
+}
+
+// Adds the constraint that states i and j differ in some latch
+void MultiProperty::differ(int i, int j) {
+  vec<Lit> clause;
+  for(pair<Lit, Lit> latch : t.latches) {
+    Lit a = frame_literal(shift_literal(latch.first, i * (t.max_index + 1)));
+    Lit b = frame_literal(shift_literal(latch.first, j * (t.max_index + 1)));
+    Lit d = Lit(new_var());
+    s.addTernary(~d, a, b);
+    s.addTernary(~d, ~a, ~b);
+    clause.push(d);
+  }
+  s.addClause(clause);
+  simple_paths++;
+}
+
+// Adds a simple path constraint for every state of the model that equals an earlier one
+// Returns false if all states are distinct
+bool MultiProperty::add_simple_paths() {
+  map<vector<bool>, int> seen;
+  bool added = false;
+  for(int i = 0; i < (int)frame.size(); i++) {
+    vector<bool> state;
+    for(pair<Lit, Lit> latch : t.latches)
+      state.push_back(s.model[frame[i] + var(latch.first)] == l_True);
+    auto it = seen.emplace(state, i);
+    if(!it.second) {
+      differ(it.first->second, i);
+      added = true;
+    }
+  }
+  return added;
+}
+
+// Drops property p, its step case activation literal is retired
+// A proven property is asserted in every state from now on
+void MultiProperty::decide(int p, Status result) {
+  status[p] = result;
+  decided_at[p] = k;
+  s.addUnit(~hold[p]);
+  if(result == status_proven)
+    for(int i = 0; i < (int)frame.size(); i++)
+      s.addUnit(~bad(p, i));
+  if(verbosity) {
+    cout << "Property " << p << (result == status_proven ? " proven" : " falsified") << " at k=" << k << endl;
+  }
+}
+
+// For k = 0, 1, ...: first the base case of every open property at bound k, then the step cases
+// on states 0..k+1. The property of state k is added to the step case of p for good, as all later
+// step cases assume it as well
+int MultiProperty::check(int max_k) {
+  int open = 0;
+  for(Status st : status)
+    open += st == status_unknown;
+
+  for(; open > 0 && (max_k < 0 || k <= max_k); k++) {
+    new_frame();
+    vec<Lit> assumps;
+
+    for(size_t p = 0; p < t.properties.size(); p++) {
+      if(status[p] != status_unknown)
+	continue;
+      assumps.clear();
+      assumps.push(init);
+      assumps.push(bad(p, k));
+      if(s.solve(assumps)) {
+	decide(p, status_falsified);
+	open--;
+      }
+    }
+
+    for(size_t p = 0; p < t.properties.size(); p++) {
+      if(status[p] != status_unknown)
+	continue;
+      s.addBinary(~hold[p], ~bad(p, k));
+      assumps.clear();
+      assumps.push(hold[p]);
+      assumps.push(bad(p, k + 1));
+      bool violated = s.solve(assumps);
+      while(violated && add_simple_paths())
+	violated = s.solve(assumps);
+      if(!violated) {
+	decide(p, status_proven);
+	open--;
+      }
+    }
+
+    if(verbosity) {
+      cout << "Multi property: k=" << k << ", " << open << " open, " << simple_paths
+	   << " simple path constraints" << endl;
+    }
+  }
+
+  int falsified = 0;
+  for(Status st : status)
+    falsified += st == status_falsified;
+  return falsified;
+}
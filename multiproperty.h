@@ -0,0 +1,54 @@
+#ifndef MULTIPROPERTY_H
+#define MULTIPROPERTY_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "util.h"
+#include <vector>
+
+using namespace std;
+
+enum Status { status_unknown, status_proven, status_falsified };
+
+// Checks all properties of a transition system by k-induction on a single solver
+// States 0..k+1 are unrolled once for all properties. The base case of property p at bound k assumes
+// the initial states and bad_p in state k, its step case assumes p in states 0..k through an
+// activation literal of p and bad_p in state k+1
+// A property is dropped as soon as it is decided. A proven property holds in every reachable state,
+// so from then on it is asserted in every state, which strengthens the queries of the others
+// Simple path constraints are added lazily as in KInduction. They only exclude paths that repeat a
+// state, which a shortest counterexample never does, so they are kept for the base cases as well
+class MultiProperty {
+public:
+  MultiProperty(TransitionSystem& t, int verbosity = 0, const SolverOptions& options = SolverOptions());
+  // Checks until every property is decided or, if max_k is not -1, up to bound max_k
+  // Returns the number of falsified properties
+  int check(int max_k = -1);
+  // Status of every property and the bound it was decided at (-1 while unknown)
+  vector<Status> status;
+  vector<int> decided_at;
+  // Number of simple path constraints added so far
+  int simple_paths = 0;
+
+private:
+  TransitionSystem& t;
+  int verbosity;
+  Solver s;
+  // First variable of every state, activation literals and auxiliary variables lie in between
+  vector<Var> frame;
+  Var next_free = 0;
+  // Activation literals of the initial states and of every property in the step cases
+  Lit init;
+  vector<Lit> hold;
+  int k = 0;
+
+  Var new_var();
+  void new_frame();
+  Lit frame_literal(Lit x);
+  Lit bad(int p, int i);
+  void add_clauses(vec<vec<Lit>>& clauses, Lit a);
+  void differ(int i, int j);
+  bool add_simple_paths();
+  void decide(int p, Status result);
+};
+#endif
@@ -0,0 +1,244 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "pdr.h"
+#include "util.h"
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+PDR::PDR(TransitionSystem& t, int verbosity, const SolverOptions& options)
+  : t(t), verbosity(verbosity), options(options), shift(t.max_index + 1), latch_of(t.max_index + 1, -1) {
+  // Bad states assert the output, the latch links need the next states in both polarities
+  // so the polarity based encoding of the circuit suffices
+  t.circuit_cnf(transition, 0, false);
+  t.latch_cnf(transition, 0);
+  for(int i = 0; i < t.nr_latches; i++)
+    latch_of[var(t.latches[i].first)] = i;
+}
+
+// Adds the next frame with its own solver, the first one is restricted to the initial states
+void PDR::new_frame() {
+  solvers.emplace_back(new Solver());
+  Solver& s = *solvers.back();
+  configure(s, options);
+  while(s.nVars() < 2 * shift) { s.newVar(); }
+  for(int i = 0; i < transition.size(); i++)
+    s.addClause(transition[i]);
+  if(frames.empty()) {
+    vec<vec<Lit>> init;
+    t.initial_latches_cnf(init);
+    for(int i = 0; i < init.size(); i++)
+      s.addClause(init[i]);
+  }
+  frames.emplace_back();
+}
+
+// Adds the lemma blocking c to the solvers of frames from..level and stores it in frame level
+// Lemmas of these frames that block a subset of c are dropped
+void PDR::add_lemma(const Cube& c, int level, int from) {
+  vec<Lit> clause;
+  for(Lit l : c)
+    clause.push(~l);
+  for(int i = from; i <= level; i++) {
+    vector<Cube>& f = frames[i];
+    f.erase(remove_if(f.begin(), f.end(), [&](const Cube& g) {
+	  return includes(g.begin(), g.end(), c.begin(), c.end()); }), f.end());
+    solvers[i]->addClause(clause);
+  }
+  frames[level].push_back(c);
+}
+
+// True iff a lemma of frame level or above blocks a subset of c
+bool PDR::blocked(const Cube& c, int level) {
+  for(int i = level; i < (int)frames.size(); i++)
+    for(const Cube& g : frames[i])
+      if(includes(c.begin(), c.end(), g.begin(), g.end()))
+	return true;
+  return false;
+}
+
+// True iff c contains an initial state, i.e. all of its literals are negative
+bool PDR::initial(const Cube& c) {
+  for(Lit l : c)
+    if(!sign(l))
+      return false;
+  return true;
+}
+
+// Checks whether F_level /\ ~c /\ T /\ c' is unsatisfiable, so c can only be entered from c itself
+// If it is, core is set to the literals of c whose next state is part of the final conflict,
+// keeping a positive literal of c so that the core excludes the initial states as well
+// Otherwise predecessor is set to the lifted cube of the state that enters c
+bool PDR::relative_inductive(const Cube& c, int level, Cube* core, Cube* predecessor) {
+  Solver& s = *solvers[level];
+  Lit a = Lit(s.newVar());
+  vec<Lit> clause, assumps;
+  clause.push(~a);
+  assumps.push(a);
+  for(Lit l : c) {
+    clause.push(~l);
+    assumps.push(shift_literal(l, shift));
+  }
+  s.addClause(clause);
+
+  bool sat = s.solve(assumps);
+  if(sat && predecessor != NULL)
+    *predecessor = lift(s, &c);
+  if(!sat && core != NULL) {
+    core->clear();
+    for(Lit l : c)
+      for(int i = 0; i < s.conflict.size(); i++)
+	if(s.conflict[i] == ~shift_literal(l, shift)) {
+	  core->push_back(l);
+	  break;
+	}
+    if(initial(*core)) {
+      for(Lit l : c)
+	if(!sign(l)) {
+	  core->push_back(l);
+	  break;
+	}
+      sort(core->begin(), core->end());
+    }
+  }
+  s.addUnit(~a);
+  return !sat;
+}
+
+// Drops literals of c as long as it stays inductive relative to F_{level-1} and excludes the initial states
+PDR::Cube PDR::generalize(Cube c, int level) {
+  for(size_t i = 0; i < c.size() && c.size() > 1;) {
+    Cube candidate = c, core;
+    candidate.erase(candidate.begin() + i);
+    if(!initial(candidate) && relative_inductive(candidate, level - 1, &core, NULL))
+      c = core;
+    else
+      i++;
+  }
+  return c;
+}
+
+// Blocks the bad cube c in the top frame by blocking its predecessors in lower frames first
+// Every lemma is pushed to the highest frame it holds in
+// Returns false if a chain of predecessors reaches the initial states
+bool PDR::block(const Cube& c) {
+  int k = depth();
+  priority_queue<Obligation> queue;
+  queue.push({k, c});
+  while(!queue.empty()) {
+    Obligation o = queue.top();
+    if(initial(o.cube))
+      return false;
+    if(blocked(o.cube, o.level)) {
+      queue.pop();
+      continue;
+    }
+    Cube core, predecessor;
+    if(relative_inductive(o.cube, o.level - 1, &core, &predecessor)) {
+      queue.pop();
+      Cube lemma = generalize(core, o.level);
+      int level = o.level;
+      while(level < k && relative_inductive(lemma, level, NULL, NULL))
+	level++;
+      add_lemma(lemma, level);
+      // The cube still leads to a bad state, so it is blocked in the next frame as well
+      if(level < k)
+	queue.push({level + 1, o.cube});
+    }
+    else
+      queue.push({o.level - 1, predecessor});
+  }
+  return true;
+}
+
+// Moves every lemma that is inductive relative to its frame to the next frame
+// Returns true if a frame becomes empty: it equals the next one, which is an inductive invariant
+bool PDR::propagate() {
+  int k = depth();
+  for(int i = 1; i < k; i++) {
+    vector<Cube> lemmas = frames[i];
+    for(const Cube& c : lemmas)
+      if(relative_inductive(c, i, NULL, NULL)) {
+	frames[i].erase(find(frames[i].begin(), frames[i].end(), c));
+	add_lemma(c, i + 1, i + 1);
+      }
+    if(frames[i].empty())
+      return true;
+  }
+  return false;
+}
+
+// Ternary simulation of state 0 under the model of s: latches are set to X one at a time and kept
+// at X as long as every literal of successor (or the output if there is none) stays determined
+// Inputs keep their values. Returns the cube of the remaining latches
+PDR::Cube PDR::lift(Solver& s, const Cube* successor) {
+  const char X = 2;
+  vector<char> value(shift);
+  for(Var v = 0; v < shift; v++)
+    value[v] = s.model[v] == l_True;
+  auto eval = [&](Lit x) -> char {
+    char v = value[var(x)];
+    return v == X ? X : v ^ sign(x);
+  };
+  auto simulate = [&]() {
+    for(int i = 0; i < t.nr_gates; i++) {
+      char a = eval(t.gate_rhs0[i]), b = eval(t.gate_rhs1[i]);
+      value[var(t.gate_lhs[i])] = (a == 0 || b == 0) ? 0 : (a == 1 && b == 1) ? 1 : X;
+    }
+  };
+  auto determined = [&]() {
+    if(successor == NULL)
+      return eval(t.output) == 1;
+    for(Lit l : *successor)
+      if(eval(t.latches[latch_of[var(l)]].second) != !sign(l))
+	return false;
+    return true;
+  };
+
+  for(pair<Lit, Lit> latch : t.latches) {
+    Var v = var(latch.first);
+    char saved = value[v];
+    value[v] = X;
+    simulate();
+    if(!determined())
+      value[v] = saved;
+  }
+
+  Cube c;
+  for(pair<Lit, Lit> latch : t.latches) {
+    Var v = var(latch.first);
+    if(value[v] != X)
+      c.push_back(Lit(v, !value[v]));
+  }
+  sort(c.begin(), c.end());
+  return c;
+}
+
+// Blocks all bad states of the top frame, then opens a new frame and propagates lemmas
+// until a frame becomes an inductive invariant or a bad state turns out to be reachable
+bool PDR::check() {
+  vec<Lit> bad(1, t.output);
+  new_frame();
+  if(solvers[0]->solve(bad))
+    return false;
+
+  new_frame();
+  for(;;) {
+    Solver& s = *solvers.back();
+    while(s.solve(bad))
+      if(!block(lift(s, NULL)))
+	return false;
+
+    new_frame();
+    bool invariant = propagate();
+    if(verbosity) {
+      cout << "PDR depth " << depth() << ", lemmas per frame:";
+      for(int i = 1; i <= depth(); i++)
+	cout << " " << frames[i].size();
+      cout << endl;
+    }
+    if(invariant)
+      return true;
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef PDR_H
+#define PDR_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include "transition_system.h"
+#include "util.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Property directed reachability (IC3)
+// Frame F_0 is the initial states, F_i over-approximates the states reachable in at most i steps
+// Lemmas are stored at the highest frame they are known to hold in, frame i's solver holds the
+// transition relation and the lemmas of all frames >= i. Queries are made on these solvers with
+// temporary clauses switched by activation literals, no proof is logged
+// Cubes are sorted conjunctions of latch literals of state 0, state 1 is the next state
+class PDR {
+public:
+  PDR(TransitionSystem& t, int verbosity = 0, const SolverOptions& options = SolverOptions());
+  // Returns true iff the property holds in every reachable state
+  bool check();
+  // Number of frames after F_0
+  int depth() { return frames.size() - 1; }
+
+private:
+  typedef vector<Lit> Cube;
+  // Cube that has to be blocked in frame level, the lowest level is handled first
+  struct Obligation {
+    int level;
+    Cube cube;
+    bool operator<(const Obligation& o) const { return level > o.level; }
+  };
+
+  TransitionSystem& t;
+  int verbosity;
+  SolverOptions options;
+  // Offset of the variables of state 1
+  int shift;
+  // One transition step: the circuit of state 0 and the latches of state 1
+  vec<vec<Lit>> transition;
+  vector<unique_ptr<Solver>> solvers;
+  // Lemmas by the highest frame they are known to hold in, a lemma blocks its cube
+  vector<vector<Cube>> frames;
+  // Index of the latch of every variable, -1 if none
+  vector<int> latch_of;
+
+  void new_frame();
+  void add_lemma(const Cube& c, int level, int from = 1);
+  bool blocked(const Cube& c, int level);
+  bool initial(const Cube& c);
+  bool relative_inductive(const Cube& c, int level, Cube* core, Cube* predecessor);
+  Cube generalize(Cube c, int level);
+  bool block(const Cube& c);
+  bool propagate();
+  Cube lift(Solver& s, const Cube* successor);
+};
+#endif
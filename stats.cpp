@@ -0,0 +1,108 @@
+#include "MiniSat-p_v1.14/Solver.h"
+#include "stats.h"
+#include <iostream>
+
+using namespace std;
+
+PhaseTimer::PhaseTimer(PhaseStats& phase, const SolverStats* s, const Proof* proof)
+  : phase(phase), s(s), proof(proof), start(chrono::steady_clock::now()) {
+  if(s != NULL)
+    before = *s;
+  if(proof != NULL)
+    proof_before = proof->bytes();
+}
+
+PhaseTimer::~PhaseTimer() {
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  phase.calls++;
+  phase.seconds += elapsed.count();
+  if(s != NULL) {
+    phase.decisions += s->decisions - before.decisions;
+    phase.propagations += s->propagations - before.propagations;
+    phase.conflicts += s->conflicts - before.conflicts;
+  }
+  if(proof != NULL)
+    phase.proof_bytes += proof->bytes() - proof_before;
+}
+
+vector<pair<string, uint64>> MemoryStats::subsystems() const {
+  return {{"bmc_clauses", bmc_clauses}, {"bmc_watches", bmc_watches}, {"itp_clauses", itp_clauses},
+	  {"itp_watches", itp_watches}, {"fixpoint_clauses", fixpoint_clauses}, {"fixpoint_watches", fixpoint_watches},
+	  {"proof", proof}, {"traverser_clauses", traverser_clauses}, {"aig", aig}};
+}
+
+uint64 MemoryStats::total() const {
+  uint64 total = 0;
+  for(auto& s : subsystems())
+    total += s.second;
+  return total;
+}
+
+void Stats::account(const MemoryStats& m) {
+  memory = m;
+  peak_memory = std::max(peak_memory, m.total());
+  if(memory_limit > 0 && m.total() > memory_limit)
+    throw MemoryLimit();
+}
+
+void Stats::print_memory(ostream& out) const {
+  out << "Memory: " << memory.total() / 1024 << " KB accounted (peak " << peak_memory / 1024 << " KB)";
+  for(auto& s : memory.subsystems())
+    out << ", " << s.first << " " << s.second / 1024 << " KB";
+  out << endl;
+}
+
+vector<pair<string, const PhaseStats*>> Stats::phases() const {
+  return {{"parse", &parse}, {"preprocess", &preprocess}, {"bmc", &bmc}, {"b_presolve", &b_presolve},
+	  {"a_solve", &a_solve}, {"interpolation", &interpolation}, {"sweep", &sweep}, {"fixpoint", &fixpoint}};
+}
+
+void Stats::print(ostream& out) const {
+  for(auto& p : phases()) {
+    if(p.second->calls == 0)
+      continue;
+    out << "Phase " << p.first << ": " << p.second->calls << " calls, " << p.second->seconds * 1000 << " ms";
+    if(p.second->propagations > 0) {
+      out << ", " << p.second->conflicts << " conflicts, " << p.second->propagations << " propagations";
+    }
+    if(p.second->proof_bytes > 0) { out << ", " << p.second->proof_bytes << " proof bytes"; }
+    out << endl;
+  }
+  print_memory(out);
+}
+
+// The verdict may span several lines, which are kept as one string with "\n"
+void Stats::print_json(ostream& out, const string& verdict, double seconds) const {
+  string escaped;
+  for(char c : verdict)
+    escaped += c == '\n' ? "\\n" : c == '"' ? "\\\"" : string(1, c);
+
+  out << "{" << endl;
+  out << "  \"verdict\": \"" << escaped << "\"," << endl;
+  out << "  \"seconds\": " << seconds << "," << endl;
+  out << "  \"phases\": {" << endl;
+  auto all = phases();
+  for(size_t i = 0; i < all.size(); i++) {
+    const PhaseStats& p = *all[i].second;
+    out << "    \"" << all[i].first << "\": {\"calls\": " << p.calls << ", \"seconds\": " << p.seconds
+	<< ", \"decisions\": " << p.decisions << ", \"propagations\": " << p.propagations
+	<< ", \"conflicts\": " << p.conflicts << ", \"proof_bytes\": " << p.proof_bytes << "}"
+	<< (i + 1 < all.size() ? "," : "") << endl;
+  }
+  out << "  }," << endl;
+  out << "  \"memory_bytes\": {\"total\": " << memory.total() << ", \"peak\": " << peak_memory;
+  for(auto& s : memory.subsystems())
+    out << ", \"" << s.first << "\": " << s.second;
+  out << "}," << endl;
+  out << "  \"iterations\": [" << endl;
+  for(size_t i = 0; i < iterations.size(); i++) {
+    const IterationStats& it = iterations[i];
+    out << "    {\"outer\": " << it.outer << ", \"inner\": " << it.inner << ", \"conflicts\": " << it.conflicts
+	<< ", \"proof_clauses\": " << it.proof_clauses << ", \"core_clauses\": " << it.core_clauses
+	<< ", \"interpolant_clauses\": " << it.interpolant_clauses
+	<< ", \"interpolant_nodes\": " << it.interpolant_nodes << ", \"next_free\": " << it.next_free
+	<< ", \"init_size\": " << it.init_size << "}" << (i + 1 < iterations.size() ? "," : "") << endl;
+  }
+  out << "  ]" << endl;
+  out << "}" << endl;
+}
@@ -0,0 +1,111 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "MiniSat-p_v1.14/Solver.h"
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Time and solver work of a phase, summed over all its calls
+// Solver work is only counted for phases that run a solver, proof bytes for those that log a proof
+struct PhaseStats {
+  int calls = 0;
+  double seconds = 0;
+  uint64 decisions = 0;
+  uint64 propagations = 0;
+  uint64 conflicts = 0;
+  uint64 proof_bytes = 0;
+};
+
+// Adds the time from its construction to its destruction to phase as one call,
+// the work solver statistics s record meanwhile unless s is NULL
+// and the bytes logged to proof meanwhile unless proof is NULL
+// Only reads the clock and the counters, so it can wrap every call of a hot phase
+class PhaseTimer {
+public:
+  PhaseTimer(PhaseStats& phase, const SolverStats* s = NULL, const Proof* proof = NULL);
+  ~PhaseTimer();
+private:
+  PhaseStats& phase;
+  const SolverStats* s;
+  SolverStats before;
+  const Proof* proof;
+  uint64 proof_before = 0;
+  chrono::steady_clock::time_point start;
+};
+
+// One inner iteration of imc: the A solve for bound outer with inner interpolants in the initial states
+struct IterationStats {
+  int outer = 0;
+  int inner = 0;
+  // Conflicts of the A solve
+  uint64 conflicts = 0;
+  // Clauses of the proof so far and of the core of this refutation (only known with -f, -1 otherwise)
+  int proof_clauses = 0;
+  int core_clauses = -1;
+  // Cnf clauses and aig nodes encoded for the interpolant, 0 for a spurious counterexample
+  int interpolant_clauses = 0;
+  int interpolant_nodes = 0;
+  // First unused variable after the iteration and number of disjuncts of the initial states
+  Var next_free = 0;
+  int init_size = 0;
+};
+
+// Bytes held by the main data structures of a run, estimated from their sizes when a snapshot is taken
+struct MemoryStats {
+  // Clause databases and watch lists of the bmc, the interpolating and the fixpoint solver
+  uint64 bmc_clauses = 0;
+  uint64 bmc_watches = 0;
+  uint64 itp_clauses = 0;
+  uint64 itp_watches = 0;
+  uint64 fixpoint_clauses = 0;
+  uint64 fixpoint_watches = 0;
+  // Recorded proof: trace and resolution forest with -f, stored partial interpolants otherwise
+  uint64 proof = 0;
+  // Peak of Traverser::clauses during the last finalize, only used with -f
+  uint64 traverser_clauses = 0;
+  // Initial states and interpolants, which share one aig
+  uint64 aig = 0;
+
+  // Name and bytes of every subsystem
+  vector<pair<string, uint64>> subsystems() const;
+  uint64 total() const;
+};
+
+// Thrown when the accounted memory exceeds the limit of a run
+// It is a bad_alloc, so it is handled like running out of memory
+struct MemoryLimit : public bad_alloc {
+  const char* what() const noexcept override { return "memory limit exceeded"; }
+};
+
+// Statistics of a run, filled in by the bmc and imc engines
+struct Stats {
+  PhaseStats parse;
+  PhaseStats preprocess;
+  PhaseStats bmc;
+  PhaseStats b_presolve;
+  PhaseStats a_solve;
+  PhaseStats interpolation;
+  PhaseStats sweep;
+  PhaseStats fixpoint;
+  vector<IterationStats> iterations;
+  // Last memory snapshot, the largest total of all snapshots and the limit of the total (0 for none)
+  MemoryStats memory;
+  uint64 peak_memory = 0;
+  uint64 memory_limit = 0;
+
+  // Records a memory snapshot, throws MemoryLimit if it exceeds the limit
+  // Snapshots are taken between solver calls, so the limit is only checked approximately
+  void account(const MemoryStats& m);
+  void print_memory(ostream& out) const;
+
+  // Name and statistics of every phase in the order they run
+  vector<pair<string, const PhaseStats*>> phases() const;
+  void print(ostream& out) const;
+  void print_json(ostream& out, const string& verdict, double seconds) const;
+};
+#endif
@@ -0,0 +1,76 @@
+#include "../MiniSat-p_v1.14/Solver.h"
+#include "../transition_system.h"
+#include "../traverser.h"
+#include "../util.h"
+#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Checks Proof::compress against Traverser::finalize, which both extract the core of a refutation
+// The refutation is the one of the bmc query of bound frames, logged to a proof file
+// Both have to keep the same number of clauses and the same root clauses, and the compressed
+// proof has to be a core of its own
+
+// Root clauses of the core of goal, as sorted literal indices
+static vector<vector<int>> core_roots(const Traverser& trav, ClauseId goal) {
+  vector<vector<int>> roots;
+  for(ClauseId id = 0; id <= goal; id++)
+    if(trav.forest.roots[id] >= 0 && trav.kind[id] != Traverser::derived)
+      roots.emplace_back(trav.trace.begin() + trav.start[id], trav.trace.begin() + trav.start[id + 1]);
+  sort(roots.begin(), roots.end());
+  return roots;
+}
+
+int main(int argc, char* argv[]) {
+  if(argc != 3) {
+    cerr << "Usage: " << argv[0] << " file frames" << endl;
+    return 1;
+  }
+  int frames = stoi(argv[2]);
+  TransitionSystem t;
+  t.parse(argv[1]);
+  int width = t.max_index + 1;
+
+  Solver s;
+  unique_ptr<Proof> proof(attach_proof(s, proof_offline));
+  while(s.nVars() < (frames + 1) * width) { s.newVar(); }
+  vec<vec<Lit>> clauses;
+  t.initial_cnf(clauses);
+  for(int i = 0; i < frames; i++)
+    t.transition_cnf(clauses, i);
+  t.bad_cnf(clauses, 0, frames);
+  for(int i = 0; i < clauses.size(); i++)
+    s.addClause(clauses[i]);
+  if(s.solve()) {
+    cerr << argv[1] << ": property fails within " << frames << " steps, there is no refutation" << endl;
+    return 1;
+  }
+  ClauseId goal = s.okay() ? s.conflict_id : proof->last();
+
+  Traverser full;
+  proof->traverse(full, goal);
+  int core = full.finalize(goal);
+
+  Proof compressed;
+  proof->compress(compressed, goal);
+  Traverser kept;
+  compressed.traverse(kept);
+  ClauseId kept_goal = compressed.last();
+  int kept_core = kept.finalize(kept_goal);
+
+  cout << "finalize: core " << core << " of " << goal + 1 << " clauses, compress: " << kept_goal + 1
+       << " clauses" << endl;
+  if(kept_goal + 1 != core || kept_core != core) {
+    cout << "compress and finalize keep different numbers of clauses" << endl;
+    return 1;
+  }
+  if(core_roots(full, goal) != core_roots(kept, kept_goal)) {
+    cout << "compress and finalize keep different root clauses" << endl;
+    return 1;
+  }
+  return 0;
+}
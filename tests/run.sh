@@ -0,0 +1,44 @@
+#!/bin/sh
+# Regression tests, run by make test
+# Each case runs the checker on a file of this directory and expects a line of its output
+cd "$(dirname "$0")"
+status=0
+
+# check file expected [option...]
+check() {
+  file=$1
+  expected=$2
+  shift 2
+  output=$(../modelchecker "$@" "$file" 2>&1)
+  if ! printf '%s\n' "$output" | grep -qF "$expected"; then
+    echo "FAIL: $* $file: expected \"$expected\", got:"
+    echo "$output"
+    status=1
+  fi
+}
+
+# Latches with reset 1 or without reset are rejected instead of being treated as starting in false
+check reset1.aag "latches with reset value 1 are not supported"
+check reset1_bad.aag "latches with reset value 1 are not supported"
+check reset1.aig "latches with reset value 1 are not supported"
+check uninitialized.aag "uninitialized latches are not supported"
+for options in "" "-f" "-e pdr" "-e kind" "--portfolio 4" "3"; do
+  check reset0.aag OK $options
+done
+
+# The portfolio picks its own engines
+check reset0.aag "-e cannot be combined with --portfolio" -e pdr --portfolio 2
+
+# An input that cannot be mapped within the memory limit is out of memory, not a parse error
+check reset0.aag MEMOUT --mem-limit 1
+
+# Proof::compress keeps the same core as Traverser::finalize, for a refutation of 10 and of 30 frames
+for frames in 10 30; do
+  if ! ./compress counter.aag $frames; then
+    echo "FAIL: compress counter.aag $frames"
+    status=1
+  fi
+done
+
+[ $status = 0 ] && echo "All tests passed"
+exit $status
@@ -2,6 +2,15 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <unordered_map>
+#include <deque>
+#include <stdexcept>
+#include <new>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "util.h"
 #include "transition_system.h"
 #include "MiniSat-p_v1.14/SolverTypes.h"
@@ -9,126 +18,638 @@
 using namespace std;
 
 void TransitionSystem::print() {
-  // This omits the constant false
-  cout << "aag " << max_index << " " << nr_inputs << " " << nr_latches << " " << nr_outputs << " " << nr_gates << endl;
+  cout << "aag " << max_index << " " << nr_inputs << " " << nr_latches << " " << properties.size() << " " << nr_gates << endl;
   for(int i = 1; i <= nr_inputs; i++) {
     cout << 2 * i << endl;
   }
   for(int i = 0; i < nr_latches; i++) {
     cout << index(latches[i].first) << " " << index(latches[i].second) << endl;
   }
-  cout << index(output) << endl;
+  for(Lit p : properties)
+    cout << index(p) << endl;
   for(int i = 0; i < nr_gates; i++) {
-    cout << index(gates[i][0]) << " " <<  index(gates[i][1]) << " " << index(gates[i][2]) << endl;
-  }
-}
-
-// Expecting an input file in aiger ASCII format containing a single output
-void TransitionSystem::parse(string file_name) {
-  ifstream file;
-  string line;
-  int tmp;
-  try {
-    file.open(file_name);
-    if(file.is_open()) {
-      // parse first line
-      getline(file,line);
-      parse_first_line(line);
-
-      // Constant false
-      const_false = Lit(0);
-      
-      // parse inputs
-      // There seems to be no need to parse inputs (Even if negated)
-      for(int i = 0; i < nr_inputs; i++) {
-	getline(file, line);
-	if(stoi(line) % 2) {
-	  cerr << "Input is negated!!" << endl;
+    cout << index(gate_lhs[i]) << " " <<  index(gate_rhs0[i]) << " " << index(gate_rhs1[i]) << endl;
+  }
+}
+
+// Cursor over the memory mapped input file
+// Integers are scanned in place, nothing is copied or allocated per line
+struct AigerScanner {
+  const char *begin, *pos, *end;
+
+  AigerScanner(const char *data, size_t size) : begin(data), pos(data), end(data + size) {}
+
+  // Throws with the current line number
+  [[noreturn]] void error(const string& message) {
+    int line = 1;
+    for(const char *c = begin; c < pos && c < end; c++)
+      if(*c == '\n')
+	line++;
+    throw ParseError("line " + to_string(line) + ": " + message);
+  }
+
+  // Largest literal allowed by the header
+  unsigned max_lit = 0;
+
+  // Reads the next unsigned integer on the current line
+  unsigned uint() {
+    while(pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+      pos++;
+    if(pos == end)
+      error("unexpected end of file");
+    if(*pos < '0' || *pos > '9')
+      error("expected an unsigned integer");
+    unsigned x = 0;
+    while(pos < end && *pos >= '0' && *pos <= '9')
+      x = 10 * x + (*pos++ - '0');
+    return x;
+  }
+
+  // True if another unsigned integer follows on the current line
+  bool has_uint() {
+    while(pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+      pos++;
+    return pos < end && *pos >= '0' && *pos <= '9';
+  }
+
+  // Reads an unsigned integer that has to be the first of a new line
+  unsigned first_uint() {
+    next_line();
+    return uint();
+  }
+
+  // Reads a literal, checking it against the header
+  Lit lit() {
+    unsigned x = uint();
+    if(x > max_lit)
+      error("literal " + to_string(x) + " exceeds maximum variable index");
+    return toLit(x);
+  }
+
+  // Reads a literal that has to be the first of a new line
+  Lit first_lit() {
+    next_line();
+    return lit();
+  }
+
+  // Reads the optional reset value of latch (AIGER 1.9), which has to be 0
+  // Every engine and the latch folding of simplify() assume that all latches start in false,
+  // so a reset of 1 or an uninitialized latch (reset equal to the latch) is rejected
+  void reset(Lit latch) {
+    if(!has_uint())
+      return;
+    unsigned x = uint();
+    if(x == 1)
+      error("latches with reset value 1 are not supported");
+    if(x == (unsigned)index(latch))
+      error("uninitialized latches are not supported");
+    if(x != 0)
+      error("invalid reset value " + to_string(x));
+  }
+
+  // Moves past the end of the current line, ignoring anything left on it
+  void next_line() {
+    while(pos < end && *pos != '\n')
+      pos++;
+    if(pos < end)
+      pos++;
+  }
+
+  // Reads one unsigned integer of the binary AND section
+  // 7 bits per byte, least significant group first, MSB set on all but the last byte
+  unsigned delta() {
+    unsigned x = 0, i = 0;
+    unsigned char ch;
+    do {
+      if(pos == end)
+	error("unexpected end of file in AND section");
+      ch = *pos++;
+      x |= (ch & 0x7f) << (7 * i++);
+    } while(ch & 0x80);
+    return x;
+  }
+};
+
+// Read-only private mapping of a whole file, unmapped on destruction
+struct MappedFile {
+  int fd = -1;
+  const char *data = NULL;
+  size_t size = 0;
+
+  MappedFile(const string& file_name) {
+    struct stat st;
+    fd = open(file_name.c_str(), O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0)
+      throw ParseError("cannot open " + file_name);
+    size = st.st_size;
+    if(size == 0)
+      throw ParseError(file_name + " is empty");
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // A file beyond the address space limit is out of memory, not unreadable
+    if(map == MAP_FAILED && errno == ENOMEM)
+      throw bad_alloc();
+    if(map == MAP_FAILED)
+      throw ParseError("cannot map " + file_name);
+    data = (const char *)map;
+    madvise(map, size, MADV_SEQUENTIAL);
+  }
+
+  ~MappedFile() {
+    if(data != NULL)
+      munmap((void *)data, size);
+    if(fd >= 0)
+      close(fd);
+  }
+};
+
+// Expecting an input file in aiger ASCII or binary format, every output and bad property is checked
+// The format is chosen by the header ("aag" or "aig")
+// Throws ParseError describing the first problem found, returns the number of bytes parsed
+size_t TransitionSystem::parse(string file_name) {
+  MappedFile file(file_name);
+  AigerScanner in(file.data, file.size);
+
+  bool binary = parse_header(in);
+
+  // Constant false
+  const_false = Lit(0);
+
+  if(binary)
+    parse_binary(in);
+  else
+    parse_ascii(in);
+
+  sort_gates();
+  count_fanout();
+  compute_polarity();
+  compute_depth();
+  return file.size;
+}
+
+// Parses "aag M I L O A" or "aig M I L O A", returns true for the binary format
+// Of the fields "B C J F" of AIGER 1.9 bad properties are checked, justice and fairness properties
+// are skipped. Invariant constraints are rejected as ignoring them would be unsound, and so are
+// latch reset values other than 0 by the latch parsers
+bool TransitionSystem::parse_header(AigerScanner& in) {
+  if(in.end - in.pos < 3 || in.pos[0] != 'a' || (in.pos[1] != 'a' && in.pos[1] != 'i') || in.pos[2] != 'g')
+    in.error("expected header \"aag\" or \"aig\"");
+  bool binary = in.pos[1] == 'i';
+  in.pos += 3;
+
+  max_index = in.uint();
+  nr_inputs = in.uint();
+  nr_latches = in.uint();
+  nr_outputs = in.uint();
+  nr_gates = in.uint();
+  nr_bad = in.has_uint() ? in.uint() : 0;
+  nr_constraints = in.has_uint() ? in.uint() : 0;
+  nr_justice = in.has_uint() ? in.uint() : 0;
+  nr_fairness = in.has_uint() ? in.uint() : 0;
+  if(nr_outputs + nr_bad < 1)
+    in.error("expected at least one output or bad property");
+  if(nr_constraints > 0)
+    in.error("invariant constraints are not supported");
+  if(binary && max_index != nr_inputs + nr_latches + nr_gates)
+    in.error("binary format requires M = I + L + A");
+  in.max_lit = 2 * max_index + 1;
+  return binary;
+}
+
+void TransitionSystem::parse_ascii(AigerScanner& in) {
+  // parse inputs
+  // There seems to be no need to parse inputs (Even if negated)
+  for(int i = 0; i < nr_inputs; i++) {
+    if(in.first_uint() % 2) {
+      cerr << "Input is negated!!" << endl;
+    }
+  }
+
+  // parse latches, an optional reset value has to be 0
+  latches = vector<pair<Lit,Lit>>(nr_latches);
+  for(int i = 0; i < nr_latches; i++) {
+    Lit current = in.first_lit();
+    Lit next = in.lit();
+    in.reset(current);
+    latches[i] = pair<Lit,Lit>(current, next);
+  }
+
+  parse_properties(in);
+
+  // parse gates
+  gate_lhs.resize(nr_gates);
+  gate_rhs0.resize(nr_gates);
+  gate_rhs1.resize(nr_gates);
+  for(int i = 0; i < nr_gates; i++) {
+    gate_lhs[i] = in.first_lit();
+    if(sign(gate_lhs[i])) {
+      cerr << "Output of gate is negated";
+    }
+    gate_rhs0[i] = in.lit();
+    gate_rhs1[i] = in.lit();
+  }
+}
+
+// In the binary format inputs and current state literals of latches are implicit
+// Latch lines only hold the next state, AND gates are stored as two deltas:
+// lhs - rhs0 and rhs0 - rhs1 where lhs = 2 * (I + L + i + 1)
+void TransitionSystem::parse_binary(AigerScanner& in) {
+  // parse latches, an optional reset value has to be 0
+  latches = vector<pair<Lit,Lit>>(nr_latches);
+  for(int i = 0; i < nr_latches; i++) {
+    latches[i] = pair<Lit,Lit>(toLit(2 * (nr_inputs + i + 1)), in.first_lit());
+    in.reset(latches[i].first);
+  }
+
+  parse_properties(in);
+  in.next_line();
+
+  // parse gates
+  gate_lhs.resize(nr_gates);
+  gate_rhs0.resize(nr_gates);
+  gate_rhs1.resize(nr_gates);
+  for(int i = 0; i < nr_gates; i++) {
+    unsigned lhs = 2 * (nr_inputs + nr_latches + i + 1);
+    unsigned rhs0 = lhs - in.delta();
+    unsigned rhs1 = rhs0 - in.delta();
+    if(rhs0 >= lhs || rhs1 > rhs0)
+      in.error("invalid delta in AND section");
+    gate_lhs[i] = toLit(lhs);
+    gate_rhs0[i] = toLit(rhs0);
+    gate_rhs1[i] = toLit(rhs1);
+  }
+}
+
+// Reads the outputs and bad properties, then skips the justice and fairness sections
+// A justice property is given by the number of its literals, the literals follow after all counts
+void TransitionSystem::parse_properties(AigerScanner& in) {
+  properties.clear();
+  for(int i = 0; i < nr_outputs + nr_bad; i++)
+    properties.push_back(in.first_lit());
+  output = properties[0];
+
+  unsigned justice_lits = 0;
+  for(int i = 0; i < nr_justice; i++)
+    justice_lits += in.first_uint();
+  for(unsigned i = 0; i < justice_lits + nr_fairness; i++)
+    in.first_lit();
+}
+
+// Orders gates such that every gate comes after the gates it reads
+// The binary format guarantees this already, ASCII files do not
+void TransitionSystem::sort_gates() {
+  // Gate defining each variable, -1 for inputs, latches and the constant
+  vector<int> defined_by(max_index + 1, -1);
+  for(int i = 0; i < nr_gates; i++)
+    defined_by[var(gate_lhs[i])] = i;
+
+  bool sorted = true;
+  for(int i = 0; i < nr_gates && sorted; i++)
+    sorted = defined_by[var(gate_rhs0[i])] < i && defined_by[var(gate_rhs1[i])] < i;
+  if(sorted)
+    return;
+
+  // Iterative post-order DFS, state: 0 unvisited, 1 on current path, 2 done
+  vector<char> state(nr_gates, 0);
+  vector<int> order, stack;
+  order.reserve(nr_gates);
+  for(int root = 0; root < nr_gates; root++) {
+    if(state[root])
+      continue;
+    stack.push_back(root);
+    while(!stack.empty()) {
+      int g = stack.back();
+      if(state[g] == 0) {
+	state[g] = 1;
+	for(Lit x : {gate_rhs0[g], gate_rhs1[g]}) {
+	  int child = defined_by[var(x)];
+	  if(child < 0)
+	    continue;
+	  if(state[child] == 1)
+	    throw ParseError("combinational cycle through variable " + to_string(var(x)));
+	  if(state[child] == 0)
+	    stack.push_back(child);
+	}
+      } else {
+	stack.pop_back();
+	if(state[g] == 1) {
+	  state[g] = 2;
+	  order.push_back(g);
 	}
       }
+    }
+  }
+
+  vector<Lit> lhs(nr_gates), rhs0(nr_gates), rhs1(nr_gates);
+  for(int i = 0; i < nr_gates; i++) {
+    lhs[i] = gate_lhs[order[i]];
+    rhs0[i] = gate_rhs0[order[i]];
+    rhs1[i] = gate_rhs1[order[i]];
+  }
+  gate_lhs.swap(lhs);
+  gate_rhs0.swap(rhs0);
+  gate_rhs1.swap(rhs1);
+}
+
+void TransitionSystem::count_fanout() {
+  fanout.assign(max_index + 1, 0);
+  for(int i = 0; i < nr_gates; i++) {
+    fanout[var(gate_rhs0[i])]++;
+    fanout[var(gate_rhs1[i])]++;
+  }
+  for(pair<Lit, Lit> latch : latches)
+    fanout[var(latch.second)]++;
+  for(Lit p : properties)
+    fanout[var(p)]++;
+}
+
+// AIG normalization
+// Rewrites the gates in topological order with constant folding, trivial redundancy removal
+// (x /\ x, x /\ ~x) and structural hashing on the normalized fanin pair. Latches that are
+// constant (next state false or the latch itself) or equal to another latch (same next state)
+// are replaced, repeating until nothing changes. Unused variables are left for reduce_coi.
+// The latch rewrites are only sound because every latch starts in false, which the parser enforces
+// by rejecting other reset values (AigerScanner::reset). They have to be guarded by the reset of
+// each latch once other resets are supported
+void TransitionSystem::simplify() {
+  // Representative of every variable, literals are looked up through it
+  vector<Lit> repr(max_index + 1);
+  for(Var x = 0; x <= max_index; x++)
+    repr[x] = Lit(x);
+  // Latches may be merged into latches that are merged later on, so chains are followed
+  auto lookup = [&](Lit x) {
+    while(repr[var(x)] != Lit(var(x)))
+      x = sign(x) ? ~repr[var(x)] : repr[var(x)];
+    return x;
+  };
+  Lit const_true = ~const_false;
+
+  vector<Lit> lhs, rhs0, rhs1;
+  unordered_map<uint64, Lit> strash;
+  vector<char> merged(nr_latches, 0);
+  bool changed = true;
+  while(changed) {
+    changed = false;
 
-      // parse latches
-      latches = vector<pair<Lit,Lit>>(nr_latches);
-      for(int i = 0; i < nr_latches; i++) {
-	getline(file, line);
-	
-	// Remove trailing and leading whitespace
-	line.erase(0, line.find_first_not_of(" \t\n\r\f\v"));
-	line.erase(line.find_last_not_of(" \t\n\r\f\v") + 1);
-	latches[i] = pair<Lit,Lit>(toLit(stoi(line.substr(0, line.find(" ")))),toLit(stoi(line.substr(line.find(" ")+1, string::npos))));
+    lhs.clear(); rhs0.clear(); rhs1.clear();
+    strash.clear();
+    for(int i = 0; i < nr_gates; i++) {
+      Lit a = lookup(gate_rhs0[i]);
+      Lit b = lookup(gate_rhs1[i]);
+      if(b < a)
+	swap(a, b);
+
+      Lit result;
+      if(a == const_false || b == const_false || a == ~b)
+	result = const_false;
+      else if(a == const_true || a == b)
+	result = b;
+      else if(b == const_true)
+	result = a;
+      else {
+	uint64 key = ((uint64)index(a) << 32) | (uint64)index(b);
+	auto it = strash.find(key);
+	if(it != strash.end())
+	  result = it->second;
+	else {
+	  result = Lit(var(gate_lhs[i]));
+	  strash[key] = result;
+	  lhs.push_back(result);
+	  rhs0.push_back(a);
+	  rhs1.push_back(b);
+	}
       }
-      
-      // parse output
-      getline(file, line);
-      output = toLit(stoi(line));
-      
-      // parse gates
-      gates = vector<vector<Lit>>(nr_gates);
-      for(int i = 0; i < nr_gates; i++) {
-	getline(file, line);
-	// Remove trailing and leading whitespace
-	line.erase(0, line.find_first_not_of(" \t\n\r\f\v"));
-	line.erase(line.find_last_not_of(" \t\n\r\f\v") + 1);
-	
-	vector<Lit> gate(3);
-	tmp = stoi(line.substr(0, line.find(" ")));
-	if(tmp % 2) {
-	  cerr << "Output of gate is negated";
+      repr[var(gate_lhs[i])] = result;
+    }
+
+    // All latches start in false (see AigerScanner::reset), so latches with equal next state are equal
+    // and latches whose next state is false or themselves stay false
+    unordered_map<int, int> latch_by_next;
+    for(int i = 0; i < nr_latches; i++) {
+      if(merged[i])
+	continue;
+      Lit next = lookup(latches[i].second);
+      if(next == const_false || next == latches[i].first) {
+	repr[var(latches[i].first)] = const_false;
+	merged[i] = changed = true;
+      } else {
+	auto it = latch_by_next.find(index(next));
+	if(it != latch_by_next.end()) {
+	  repr[var(latches[i].first)] = latches[it->second].first;
+	  merged[i] = changed = true;
+	} else {
+	  latch_by_next[index(next)] = i;
 	}
-	gate[0] = toLit(tmp);
-	gate[1] = toLit(stoi(line.substr(line.find(" ")+1,line.find(" ", line.find(" ")))));
-	gate[2] = toLit(stoi(line.substr(line.find_last_of(" "), string::npos)));
-	gates[i] = gate;
       }
+    }
+  }
+
+  vector<pair<Lit, Lit>> kept_latches;
+  for(int i = 0; i < nr_latches; i++)
+    if(!merged[i])
+      kept_latches.push_back(pair<Lit, Lit>(latches[i].first, lookup(latches[i].second)));
+  latches.swap(kept_latches);
+  nr_latches = latches.size();
+
+  gate_lhs.swap(lhs);
+  gate_rhs0.swap(rhs0);
+  gate_rhs1.swap(rhs1);
+  nr_gates = gate_lhs.size();
+
+  for(Lit& p : properties)
+    p = lookup(p);
+  output = properties[0];
+  count_fanout();
+  compute_polarity();
+  compute_depth();
+}
+
+// Polarity in which every variable is needed, starting from the bad properties (asserted true)
+// and the latch next states (needed in both polarities, they are linked by an equivalence)
+// Gates are visited in reverse topological order, so each gate is final when it is reached
+void TransitionSystem::compute_polarity() {
+  polarity.assign(max_index + 1, pol_none);
+  auto require = [&](Lit x, char pol) {
+    if(sign(x))
+      pol = ((pol & pol_pos) ? pol_neg : pol_none) | ((pol & pol_neg) ? pol_pos : pol_none);
+    polarity[var(x)] |= pol;
+  };
+  for(Lit p : properties)
+    require(p, pol_pos);
+  for(pair<Lit, Lit> latch : latches)
+    require(latch.second, pol_both);
+  for(int i = nr_gates - 1; i >= 0; i--) {
+    char pol = polarity[var(gate_lhs[i])];
+    require(gate_rhs0[i], pol);
+    require(gate_rhs1[i], pol);
+  }
+}
+
+// Sequential distance of every variable to the nearest property, i.e. the least number of latches
+// on a path to it (-1 if there is none). 0-1 BFS: gate fanins keep the distance of the gate,
+// the next state of a latch is one step further away than the latch itself
+void TransitionSystem::compute_depth() {
+  vector<int> gate_of(max_index + 1, -1);
+  vector<int> latch_of(max_index + 1, -1);
+  for(int i = 0; i < nr_gates; i++)
+    gate_of[var(gate_lhs[i])] = i;
+  for(int i = 0; i < nr_latches; i++)
+    latch_of[var(latches[i].first)] = i;
 
-      // Handle constant false (Assuming there is at least one variable)
-      gates.push_back({const_false, Lit(1), ~Lit(1)});
-      file.close();
+  depth.assign(max_index + 1, -1);
+  deque<Var> queue;
+  auto relax = [&](Lit x, int d, bool front) {
+    if(depth[var(x)] < 0 || d < depth[var(x)]) {
+      depth[var(x)] = d;
+      if(front)
+	queue.push_front(var(x));
+      else
+	queue.push_back(var(x));
     }
+  };
+  for(Lit p : properties)
+    relax(p, 0, false);
+  while(!queue.empty()) {
+    Var x = queue.front();
+    queue.pop_front();
+    if(gate_of[x] >= 0) {
+      relax(gate_rhs0[gate_of[x]], depth[x], true);
+      relax(gate_rhs1[gate_of[x]], depth[x], true);
+    } else if(latch_of[x] >= 0) {
+      relax(latches[latch_of[x]].second, depth[x] + 1, false);
+    }
+  }
+
+  // Bucket gates (in topological order) and latches by distance
+  gates_at_depth.clear();
+  latches_at_depth.clear();
+  for(int i = 0; i < nr_gates; i++) {
+    int d = depth[var(gate_lhs[i])];
+    if(d < 0)
+      continue;
+    if((int)gates_at_depth.size() <= d)
+      gates_at_depth.resize(d + 1);
+    gates_at_depth[d].push_back(i);
   }
-  catch(...) {
-    cout << "Exception occured while parsing" << endl;
-    file.close();
+  for(int i = 0; i < nr_latches; i++) {
+    int d = depth[var(latches[i].first)];
+    if(d < 0)
+      continue;
+    if((int)latches_at_depth.size() <= d)
+      latches_at_depth.resize(d + 1);
+    latches_at_depth[d].push_back(i);
   }
 }
 
-void TransitionSystem::parse_first_line(const string &line) {
-  string tmp;
-  stringstream ss(line);
-  
-  getline(ss, tmp, ' ');
-  getline(ss, tmp, ' ');
-  max_index = stoi(tmp);
+// Cone of influence reduction
+// Keeps only the inputs, latches and gates in the transitive sequential fan-in of the properties
+// Remaining variables are renumbered densely (inputs, latches, gates), which shrinks every frame
+void TransitionSystem::reduce_coi() {
+  vector<int> gate_of(max_index + 1, -1);
+  vector<int> latch_of(max_index + 1, -1);
+  for(int i = 0; i < nr_gates; i++)
+    gate_of[var(gate_lhs[i])] = i;
+  for(int i = 0; i < nr_latches; i++)
+    latch_of[var(latches[i].first)] = i;
+
+  // Mark the cone starting from the properties
+  vector<char> in_coi(max_index + 1, 0);
+  vector<Var> stack;
+  auto mark = [&](Lit x) {
+    if(!in_coi[var(x)]) {
+      in_coi[var(x)] = 1;
+      stack.push_back(var(x));
+    }
+  };
+  for(Lit p : properties)
+    mark(p);
+  while(!stack.empty()) {
+    Var x = stack.back();
+    stack.pop_back();
+    if(gate_of[x] >= 0) {
+      mark(gate_rhs0[gate_of[x]]);
+      mark(gate_rhs1[gate_of[x]]);
+    } else if(latch_of[x] >= 0) {
+      mark(latches[latch_of[x]].second);
+    }
+  }
 
-  getline(ss, tmp, ' ');
-  nr_inputs = stoi(tmp);
+  // Renumber, variable 0 stays the constant
+  vector<Var> renamed(max_index + 1, var_Undef);
+  renamed[0] = 0;
+  Var next = 1;
+  for(Var x = 1; x <= max_index; x++)
+    if(in_coi[x] && gate_of[x] < 0 && latch_of[x] < 0)
+      renamed[x] = next++;
+  nr_inputs = next - 1;
+  for(pair<Lit, Lit> latch : latches)
+    if(in_coi[var(latch.first)])
+      renamed[var(latch.first)] = next++;
+  for(int i = 0; i < nr_gates; i++)
+    if(in_coi[var(gate_lhs[i])])
+      renamed[var(gate_lhs[i])] = next++;
+  auto rename = [&](Lit x) { return Lit(renamed[var(x)], sign(x)); };
 
-  getline(ss, tmp, ' ');
-  nr_latches = stoi(tmp);
+  vector<pair<Lit, Lit>> kept_latches;
+  for(pair<Lit, Lit> latch : latches)
+    if(in_coi[var(latch.first)])
+      kept_latches.push_back(pair<Lit, Lit>(rename(latch.first), rename(latch.second)));
+  latches.swap(kept_latches);
+  nr_latches = latches.size();
 
-  getline(ss, tmp, ' ');
-  nr_outputs = stoi(tmp);
+  int j = 0;
+  for(int i = 0; i < nr_gates; i++) {
+    if(in_coi[var(gate_lhs[i])]) {
+      gate_lhs[j] = rename(gate_lhs[i]);
+      gate_rhs0[j] = rename(gate_rhs0[i]);
+      gate_rhs1[j] = rename(gate_rhs1[i]);
+      j++;
+    }
+  }
+  nr_gates = j;
+  gate_lhs.resize(j);
+  gate_rhs0.resize(j);
+  gate_rhs1.resize(j);
 
-  getline(ss, tmp, ' ');
-  nr_gates = stoi(tmp);
+  for(Lit& p : properties)
+    p = rename(p);
+  output = properties[0];
+  max_index = next - 1;
+  count_fanout();
+  compute_polarity();
+  compute_depth();
 }
 
 // Adds clauses representing the circuit to result
 // Shifts all literals to correspond to the step + 1 state
-void TransitionSystem::circuit_cnf(vec<vec<Lit>>& result, int step) {
+// Unless full is set, gates are only encoded in the directions given by their polarity
+void TransitionSystem::circuit_cnf(vec<vec<Lit>>& result, int step, bool full) {
   Lit x1, x2, x3;
   vec<Lit> lits;
   int offset = step * (max_index + 1);
 
-  for(vector<Lit> gate : gates) {
+  for(int i = 0; i < nr_gates; i++) {
     // Account for offset of variables
-    tseitin_and(shift_literal(gate[0], offset), shift_literal(gate[1], offset),
-		shift_literal(gate[2], offset), result);
+    if(full)
+      tseitin_and(shift_literal(gate_lhs[i], offset), shift_literal(gate_rhs0[i], offset),
+		  shift_literal(gate_rhs1[i], offset), result);
+    else
+      tseitin_and(shift_literal(gate_lhs[i], offset), shift_literal(gate_rhs0[i], offset),
+		  shift_literal(gate_rhs1[i], offset), polarity[var(gate_lhs[i])] & pol_pos,
+		  polarity[var(gate_lhs[i])] & pol_neg, result);
   }
+
+  // Constant false
+  result.push(); result.last().push(~shift_literal(const_false, offset));
 }
 
 // Encodes the initial state as cnf and adds clauses to result
-void TransitionSystem::initial_cnf(vec<vec<Lit>>& result) {
+void TransitionSystem::initial_cnf(vec<vec<Lit>>& result, bool full) {
+  initial_latches_cnf(result);
+  circuit_cnf(result, 0, full);
+}
+
+// Adds the initial value (false) of every latch to result
+void TransitionSystem::initial_latches_cnf(vec<vec<Lit>>& result) {
   vec<Lit> lits;
   for(pair<Lit, Lit> latch : latches) {
     lits.push(~latch.first);
@@ -136,7 +657,44 @@ void TransitionSystem::initial_cnf(vec<vec<Lit>>& result) {
     lits.copyTo(result.last());
     lits.clear();
   }
-  circuit_cnf(result, 0);
+}
+
+// Adds the part of state "step" that is exactly d steps away from the properties:
+// the gates at distance d and, for step > 0, the links of the latches at distance d
+// to their next states in state "step - 1"
+// Adding d = 0..n for state i encodes exactly what can reach the properties of state i + n
+// Unless full is set, gates are only encoded in the directions given by their polarity
+void TransitionSystem::cone_cnf(vec<vec<Lit>>& result, int step, int d, bool full) {
+  vec<Lit> lits;
+  int offset = step * (max_index + 1);
+
+  if(d == 0) {
+    // Constant false
+    result.push(); result.last().push(~shift_literal(const_false, offset));
+  }
+
+  if(step > 0 && d < (int)latches_at_depth.size()) {
+    for(int i : latches_at_depth[d]) {
+      Lit x1 = shift_literal(latches[i].first, offset);
+      Lit x2 = shift_literal(latches[i].second, offset - (max_index + 1));
+      lits.push(~x1); lits.push(x2);
+      result.push(); lits.copyTo(result.last()); lits.clear();
+      lits.push(x1); lits.push(~x2);
+      result.push(); lits.copyTo(result.last()); lits.clear();
+    }
+  }
+
+  if(d < (int)gates_at_depth.size()) {
+    for(int i : gates_at_depth[d]) {
+      if(full)
+	tseitin_and(shift_literal(gate_lhs[i], offset), shift_literal(gate_rhs0[i], offset),
+		    shift_literal(gate_rhs1[i], offset), result);
+      else
+	tseitin_and(shift_literal(gate_lhs[i], offset), shift_literal(gate_rhs0[i], offset),
+		    shift_literal(gate_rhs1[i], offset), polarity[var(gate_lhs[i])] & pol_pos,
+		    polarity[var(gate_lhs[i])] & pol_neg, result);
+    }
+  }
 }
 
 // Add a disjunction of all bad properties for states "from"-"to" to result
@@ -148,8 +706,8 @@ void TransitionSystem::bad_cnf(vec<vec<Lit>>& result, int from, int to) {
   result.push(); lits.copyTo(result.last()); lits.clear();
 }
 
-// Adds latch-dependencies and circuit clauses of state "step + 1"
-void TransitionSystem::transition_cnf(vec<vec<Lit>>& result, int step) {
+// Links the latches of state "step + 1" to their next states in state "step"
+void TransitionSystem::latch_cnf(vec<vec<Lit>>& result, int step) {
   vec<Lit> lits;
   int from_offset = (step) * (max_index + 1);
   int to_offset = from_offset + (max_index + 1);
@@ -170,50 +728,24 @@ void TransitionSystem::transition_cnf(vec<vec<Lit>>& result, int step) {
     result.push(); lits.copyTo(result.last()); lits.clear();
 
   }
-
-  circuit_cnf(result, step+1);
-}
-
-// Adds tseitinized circuit for initial state to result
-// Next free will be used and incremented for labels
-void TransitionSystem::initial_circuit_tseitin(vec<vec<Lit>>& result, Var *next_free) {
-  // The idea is to have a label for every gate
-  // Then compute top level label l <-> (l1 /\ l2 ...)
-  vec<Lit> labels;
-  for(vector<Lit> gate : gates) {
-    // Handle conjunction
-    tseitin_and(Lit(*next_free), gate[1], gate[2], result);
-    tseitin_iff(Lit(*next_free +1), gate[0],Lit(*next_free), result);
-    labels.push(Lit(*next_free+1));
-    *next_free += 2;
-  }
-  
-  Lit left = labels[0];
-  for(int i = 1; i < labels.size(); i++) {
-    tseitin_and(Lit(*next_free), left, labels[i], result);
-    left = Lit(*next_free);
-    *next_free += 1;
-  }
 }
 
-// Adds tseitinized initial state to result
-// next_free is used for labels and will be incremented
-void TransitionSystem::initial_tseitin(vec<vec<Lit>>& result, Var *next_free) {
-  if(latches.size() > 0) {
-    Lit left = ~latches[0].first;
-    for(int i = 1; i < latches.size(); i++) {
-      tseitin_and(Lit(*next_free), left, ~latches[i].first, result);
-      left = Lit(*next_free);
-      *next_free += 1;
-    }
-    if(latches.size() > 1)
-      left = Lit(*next_free -1);
-    initial_circuit_tseitin(result, next_free);
-    tseitin_and(Lit(*next_free), left, Lit(*next_free - 1), result);
-    *next_free += 1;
-  } else {
-    initial_circuit_tseitin(result, next_free);
-  }
+// Adds latch-dependencies and circuit clauses of state "step + 1"
+void TransitionSystem::transition_cnf(vec<vec<Lit>>& result, int step, bool full) {
+  latch_cnf(result, step);
+  circuit_cnf(result, step+1, full);
 }
 
+// Builds the initial state in aig: every gate equals the conjunction of its inputs,
+// the constant is false and so are all latches
+// Returns the literal of the initial state
+Lit TransitionSystem::initial_aig(AigManager& aig) {
+  vec<Lit> conjuncts;
+  for(int i = 0; i < nr_gates; i++)
+    conjuncts.push(aig.make_iff(aig.input(gate_lhs[i]), aig.make_and(aig.input(gate_rhs0[i]), aig.input(gate_rhs1[i]))));
 
+  conjuncts.push(~aig.input(const_false));
+  for(pair<Lit, Lit> latch : latches)
+    conjuncts.push(~aig.input(latch.first));
+  return aig.make_and(conjuncts);
+}
@@ -1,11 +1,26 @@
+#ifndef TRANSITION_SYSTEM_H
+#define TRANSITION_SYSTEM_H
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 #include "MiniSat-p_v1.14/SolverTypes.h"
+#include "aig.h"
 
 using namespace std;
 
+struct AigerScanner;
+
+// Thrown when an input file cannot be read or is not an AIGER file this checker supports
+struct ParseError : public runtime_error {
+  ParseError(const string& message) : runtime_error(message) {}
+};
+
+// Polarities in which a variable is needed
+enum Polarity { pol_none = 0, pol_pos = 1, pol_neg = 2, pol_both = 3 };
+
 class TransitionSystem {
 public:
   // indices start from 0
@@ -14,19 +29,52 @@ public:
   int nr_latches;
   int nr_outputs;
   int nr_gates;
+  // Numbers of bad state properties, invariant constraints, justice and fairness properties (AIGER 1.9)
+  int nr_bad = 0;
+  int nr_constraints = 0;
+  int nr_justice = 0;
+  int nr_fairness = 0;
   int const_index;
   vector<pair<Lit, Lit>> latches;
-  vector<vector<Lit>> gates;
+  // AND gates in topological order, stored as struct of arrays
+  // Gate i defines gate_lhs[i] <-> gate_rhs0[i] /\ gate_rhs1[i]
+  vector<Lit> gate_lhs;
+  vector<Lit> gate_rhs0;
+  vector<Lit> gate_rhs1;
+  // Number of gate inputs, latch next states and outputs reading each variable
+  vector<unsigned> fanout;
+  // Polarity in which each variable is needed by the output and the latches
+  vector<char> polarity;
+  // Sequential distance of each variable to the output (-1 if unreachable)
+  // and the gates and latches bucketed by it
+  vector<int> depth;
+  vector<vector<int>> gates_at_depth;
+  vector<vector<int>> latches_at_depth;
+  // Bad state literals: every output followed by every bad property
+  vector<Lit> properties;
+  // The property checked by the single property engines, properties[0]
   Lit output;
   // We use variable 0 to represent false
   Lit const_false;
-  void parse(string file);
-  void parse_first_line(const string &line);
+  size_t parse(string file);
+  bool parse_header(AigerScanner& in);
+  void parse_ascii(AigerScanner& in);
+  void parse_binary(AigerScanner& in);
+  void parse_properties(AigerScanner& in);
+  void sort_gates();
+  void count_fanout();
+  void compute_polarity();
+  void compute_depth();
+  void simplify();
+  void reduce_coi();
   void print();
-  void circuit_cnf(vec<vec<Lit>>& result, int step);
-  void initial_circuit_tseitin(vec<vec<Lit>>& result, Var *next_free);
-  void initial_cnf(vec<vec<Lit>>& result);
+  void circuit_cnf(vec<vec<Lit>>& result, int step, bool full = true);
+  void initial_cnf(vec<vec<Lit>>& result, bool full = true);
+  void initial_latches_cnf(vec<vec<Lit>>& result);
+  void cone_cnf(vec<vec<Lit>>& result, int step, int d, bool full = true);
   void bad_cnf(vec<vec<Lit>>& result, int from, int to);
-  void transition_cnf(vec<vec<Lit>>& result, int step);
-  void initial_tseitin(vec<vec<Lit>>& result, Var *next_free);
+  void latch_cnf(vec<vec<Lit>>& result, int step);
+  void transition_cnf(vec<vec<Lit>>& result, int step, bool full = true);
+  Lit initial_aig(AigManager& aig);
 };
+#endif
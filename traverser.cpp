@@ -6,6 +6,7 @@
 #include <vector>
 #include <set>
 #include <memory>
+#include <algorithm>
 
 using namespace std;
 
@@ -30,48 +31,122 @@ bool Traverser::resolve(vec<Lit>& main, vec<Lit>& other, Var x) {
 }
 
 void Traverser::root(const vec<Lit>& c) {
-  clauses.push();
-  c.copyTo(clauses.last());
-
-  shared_ptr<Node> root = make_shared<Node>();
-  root->clause_id = forest.roots.size();
-  forest.roots.push_back(root);
-  root->int_trivial = init;
+  for (int i = 0; i < c.size(); i++)
+    trace.push_back(index(c[i]));
+  start.push_back(trace.size());
+  kind.push_back(init);
 }
   
 void Traverser::chain(const vec<ClauseId>& cs, const vec<Var>& xs) {
-  clauses.push();
-  vec<Lit>& resolvent = clauses.last();
-  clauses[cs[0]].copyTo(resolvent);
-
-  shared_ptr<Node> node1, node2, parent;
-  node1 = make_shared<Node>();
-  node1->clause_id=cs[0];
+  trace.push_back(cs[0]);
   for (int i = 0; i < xs.size(); i++) {
-    node2 = make_shared<Node>();
-    node2->clause_id=cs[i+1];
+    trace.push_back(xs[i]);
+    trace.push_back(cs[i+1]);
+  }
+  start.push_back(trace.size());
+  kind.push_back(derived);
+}
+
+int Traverser::finalize(ClauseId goal) {
+  // Antecedents always have smaller ids, so a single backwards sweep marks the core
+  // The first reference met on the way is the last use of a clause, its literals can be dropped after it
+  vector<ClauseId> last_use(goal+1, -1);
+  last_use[goal] = goal;
+  int core = 0;
+  size_t size = 0;
+  for (ClauseId id = goal; id >= 0; id--) {
+    if (last_use[id] < 0)
+      continue;
+    core++;
+    if (kind[id] == derived) {
+      size += (start[id+1] - start[id]) / 2;
+      for (int i = start[id]; i < start[id+1]; i += 2)
+	if (last_use[trace[i]] < 0)
+	  last_use[trace[i]] = id;
+    } else
+      size++;
+  }
+
+  forest.nodes.clear();
+  forest.nodes.reserve(size);
+  forest.roots.assign(goal+1, -1);
+  clauses.clear();
+  clauses.growTo(goal+1);
+  size_t clause_bytes = 0;
+  peak_clause_bytes = 0;
+  for (ClauseId id = 0; id <= goal; id++) {
+    if (last_use[id] < 0)
+      continue;
+    if (kind[id] == derived) {
+      add_chain(id);
+      clause_bytes += clauses[id].capacity() * sizeof(Lit);
+      peak_clause_bytes = std::max(peak_clause_bytes, clause_bytes);
+      for (int i = start[id]; i < start[id+1]; i += 2)
+	if (last_use[trace[i]] == id) {
+	  clause_bytes -= clauses[trace[i]].capacity() * sizeof(Lit);
+	  clauses[trace[i]].clear(true);
+	}
+    } else {
+      add_root(id);
+      clause_bytes += clauses[id].capacity() * sizeof(Lit);
+      peak_clause_bytes = std::max(peak_clause_bytes, clause_bytes);
+    }
+  }
+
+  // The clauses were only needed to determine the polarity of the pivots
+  // The trace is kept, the solver may go on and finalize a later goal
+  clauses.clear(true);
+  return core;
+}
 
-    bool sign = resolve(resolvent, clauses[cs[i+1]], xs[i]);
+size_t Traverser::bytes() const {
+  return kind.capacity() * sizeof(signed char) + (start.capacity() + trace.capacity()) * sizeof(int)
+    + forest.nodes.capacity() * sizeof(Node) + forest.roots.capacity() * sizeof(int);
+}
+
+void Traverser::add_root(ClauseId id) {
+  for (int i = start[id]; i < start[id+1]; i++)
+    clauses[id].push(toLit(trace[i]));
+
+  Node root;
+  root.clause_id = id;
+  root.int_trivial = (Trivial)kind[id];
+  forest.roots[id] = forest.nodes.size();
+  forest.nodes.push_back(root);
+}
+
+void Traverser::add_chain(ClauseId id) {
+  int i = start[id];
+  vec<Lit>& resolvent = clauses[id];
+  clauses[trace[i]].copyTo(resolvent);
+
+  // Antecedents are referenced by the index of their own node
+  int node1 = forest.roots[trace[i]];
+  for (i++; i < start[id+1]; i += 2) {
+    Var x = trace[i];
+    int node2 = forest.roots[trace[i+1]];
 
-    parent = make_shared<Node>();
-    parent->resolved_on = xs[i];
-    parent->negative = (sign?node1:node2);
-    parent->positive = (sign?node2:node1);
+    bool sign = resolve(resolvent, clauses[trace[i+1]], x);
 
-    node1 = parent;
+    Node parent(x);
+    parent.negative = (sign?node1:node2);
+    parent.positive = (sign?node2:node1);
+
+    node1 = forest.nodes.size();
+    forest.nodes.push_back(parent);
   }
-  node1->clause_id=forest.roots.size();
-  forest.roots.push_back(node1);
+  forest.nodes[node1].clause_id=id;
+  forest.roots[id] = node1;
 }
 
-void ResolutionForest::print_subtree(shared_ptr<Node> it) {
-  if(it == NULL)
+void ResolutionForest::print_subtree(int it) {
+  if(it < 0)
     return;
-  it->print();
+  nodes[it].print();
   cout << "Left subtree:" << endl;
-  print_subtree(it->negative);
+  print_subtree(nodes[it].negative);
   cout << "Right subtree:" << endl;
-  print_subtree(it->positive);
+  print_subtree(nodes[it].positive);
 }
   
 void ResolutionForest::print() {
@@ -81,154 +156,137 @@ void ResolutionForest::print() {
   }
 }
 
-// Computes interpolant for a node recursively
+// Computes interpolant for a node
 // Assumes that all leaves are initialized to true/false
-// Uses tseitin translation: We keep track of labels in the nodes and aggregate all produced clauses in the result vector
-void ResolutionForest::compute_partial_interpolant(shared_ptr<Node> node, set<Var> *shared, Var lowest_b, Var highest_b, int index, Var *next_free, vec<vec<Lit>>& result){
-  // "array" index parameter does not match the clause id of the current node, i.e.
-  // we are  currently in a resolution chain at "index" and need interpolant of "clause_id"
-  // we compute the interpolant of the node at "clause_id" and then populate "node"
-  if(node->clause_id >= 0 && node->clause_id != index) {
-    compute_partial_interpolant(roots[node->clause_id], shared, lowest_b, highest_b, node->clause_id, next_free, result);
-    node->int_trivial = roots[node->clause_id]->int_trivial;
-    node->label=roots[node->clause_id]->label;
-  }
-  // If a node has a trivial interpolant or label, we are done
-  else if(node->int_trivial == int_undef){
-    // Check if we already have an interpolant
-    if(node->label == lit_Undef) {
-      compute_partial_interpolant(node->negative, shared, lowest_b, highest_b, index, next_free, result);
-      compute_partial_interpolant(node->positive, shared, lowest_b, highest_b, index, next_free, result);
-
-      if(node->resolved_on >= lowest_b && node->resolved_on <= highest_b) {
+// The interpolants are built in aig, nodes keep track of their literal there
+// The DAG is traversed in post-order with an explicit stack, so deep proofs cannot overflow the call stack
+// Interpolants are memoized in the nodes, every node is computed once
+void ResolutionForest::compute_partial_interpolant(int node, const vector<char>& locality, int shift, AigManager& aig){
+  struct Frame {
+    int node;
+    bool expanded;
+  };
+  vector<Frame> stack;
+  stack.push_back({node, false});
+  while(!stack.empty()) {
+    Frame& frame = stack.back();
+    Node *n = &nodes[frame.node];
+
+    if(n->done()) {
+      // If a node has a trivial interpolant or label, we are done
+      stack.pop_back();
+    } else if(!frame.expanded) {
+      frame.expanded = true;
+      // Negative side first, it ends up on top
+      stack.push_back({n->positive, false});
+      stack.push_back({n->negative, false});
+    } else {
+      const Node& negative = nodes[n->negative];
+      const Node& positive = nodes[n->positive];
+      Locality pivot = locality_of(locality, n->resolved_on);
+      if(pivot == local_b) {
 	// Resolved on B
-	resolve_B(node, next_free, result);
-      } else if (shared->count(node->resolved_on)) {
+	resolve_B(*n, negative, positive, aig);
+      } else if (pivot == shared_ab) {
 	// Resolved on shared
-	resolve_shared(node, next_free, result);
+	resolve_shared(*n, aig.input(Lit(n->resolved_on - shift)), negative, positive, aig);
       } else {
 	// Resolved on A
-	resolve_A(node, next_free, result);
+	resolve_A(*n, negative, positive, aig);
       }
+      stack.pop_back();
     }
   }
 }
 
-void ResolutionForest::resolve_B(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result) {
-  // I_1 /\ I_2
-  switch(node->negative->int_trivial){
-  case int_f: node->int_trivial=int_f; break;
-  case int_t:
-    if(node->positive->int_trivial != int_undef)
-      node->int_trivial=node->positive->int_trivial;
-    else
-      node->label = node->positive->label;
-    break;
-  case int_undef:
-    switch(node->positive->int_trivial){
-    case int_f: node->int_trivial=int_f; break;
-    case int_t:
-      node->label = node->negative->label;
-      break;
-    case int_undef:
-      node->label = Lit(*next_free); *next_free+=1;
-      tseitin_and(node->label, node->negative->label, node->positive->label, result); 
-      break;
-    }
-    break;
-  }
+void Interpolant::set(Lit x) {
+  if(x == aig_true)
+    int_trivial = int_t;
+  else if(x == aig_false)
+    int_trivial = int_f;
+  else
+    label = x;
 }
 
+void resolve_B(Interpolant& node, const Interpolant& negative, const Interpolant& positive, AigManager& aig) {
+  // I_1 /\ I_2
+  node.set(aig.make_and(negative.aig(), positive.aig()));
+}
 
-void ResolutionForest::resolve_A(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result) {
+void resolve_A(Interpolant& node, const Interpolant& negative, const Interpolant& positive, AigManager& aig) {
   // I_1 \/ I_2
-  switch(node->negative->int_trivial){
-  case int_t: node->int_trivial=int_t; break;
-  case int_f:
-    if(node->positive->int_trivial != int_undef)
-      node->int_trivial=node->positive->int_trivial;
-    else
-      node->label=node->positive->label;
-    break;
-  case int_undef:
-    switch(node->positive->int_trivial){
-    case int_t: node->int_trivial=int_t; break;
-    case int_f:
-      node->label=node->negative->label;
-      break;
-    case int_undef:	      
-      node->label=Lit(*next_free); *next_free+=1;
-      tseitin_or(node->label, node->negative->label, node->positive->label, result);
-      break;
-    }
-    break;
-  }
+  node.set(aig.make_or(negative.aig(), positive.aig()));
 }
 
-void ResolutionForest::resolve_shared(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result) {
-  vec<Lit> lits;
-  vec<vec<Lit>> clauses;
-  
-  // Handle clause containing positive resolvent
-  switch(node->positive->int_trivial){
-  case int_t:
-    break;
-  case int_f:
-    lits.push(Lit(node->resolved_on));
-    clauses.push(); lits.copyTo(clauses.last()); lits.clear();
-    break;
-  case int_undef:
-    lits.push(Lit(node->resolved_on));
-    lits.push(Lit(node->positive->label));
-    clauses.push(); lits.copyTo(clauses.last()); lits.clear();
-    break;
-  }
-  
-  // Handle clause containing negative resolvent
-  switch(node->negative->int_trivial){
-  case int_t:
-    break;
-  case int_f:
-    lits.push(~Lit(node->resolved_on));
-    clauses.push(); lits.copyTo(clauses.last()); lits.clear();
-    break;
-  case int_undef:
-    lits.push(~Lit(node->resolved_on));
-    lits.push(Lit(node->negative->label));
-    clauses.push(); lits.copyTo(clauses.last()); lits.clear();
-    break;
-  }
-  // clauses contains computed interpolant. Now tseitenize
-  if(clauses.size() == 0){
-    // Both interpolants were true
-    node->int_trivial=int_t;
-  } else if(clauses.size() == 1) {
-    if(clauses[0].size() == 1) {
-      // Single literal, just propagate forward as label
-      node->label=clauses[0][0];
+void resolve_shared(Interpolant& node, Lit x, const Interpolant& negative, const Interpolant& positive, AigManager& aig) {
+  // (x \/ I_1) /\ (~x \/ I_2) where I_1 belongs to the clause containing x positively
+  node.set(aig.make_and(aig.make_or(x, positive.aig()), aig.make_or(~x, negative.aig())));
+}
+
+InterpolatingTraverser::InterpolatingTraverser(const vector<char>& locality, int shift, AigManager& aig)
+  : locality(locality), shift(shift), aig(aig) {}
+
+const InterpolatingTraverser::Partial& InterpolatingTraverser::lookup(ClauseId c) const {
+  static const Partial trivially_true = [] { Partial p; p.int_trivial = int_t; return p; }();
+  auto it = partials.find(c);
+  return it == partials.end() ? trivially_true : it->second;
+}
+
+// Every entry of the hash map is a separate allocation holding its key, value and a link
+size_t InterpolatingTraverser::bytes() const {
+  size_t bytes = partials.bucket_count() * sizeof(void*);
+  for (auto& p : partials)
+    bytes += sizeof(p) + sizeof(void*) + p.second.shared.capacity() * sizeof(Lit);
+  return bytes;
+}
+
+void InterpolatingTraverser::store(ClauseId c, const Partial& p) {
+  if(p.int_trivial != int_t || !p.shared.empty())
+    partials[c] = p;
+}
+
+void InterpolatingTraverser::root(const vec<Lit>& c) {
+  Partial p;
+  p.int_trivial = init;
+  for (int i = 0; i < c.size(); i++)
+    if (is_shared(var(c[i])))
+      p.shared.push_back(c[i]);
+  store(next_id++, p);
+}
+
+void InterpolatingTraverser::chain(const vec<ClauseId>& cs, const vec<Var>& xs) {
+  Partial resolvent = lookup(cs[0]);
+  for (int i = 0; i < xs.size(); i++) {
+    const Partial& other = lookup(cs[i+1]);
+    Var x = xs[i];
+
+    Interpolant itp;
+    if(locality_of(locality, x) == local_b) {
+      // Resolved on B
+      resolve_B(itp, resolvent, other, aig);
+    } else if(is_shared(x)) {
+      // Resolved on shared, the polarity of the pivot is known from the shared literals
+      bool negative = find(resolvent.shared.begin(), resolvent.shared.end(), ~Lit(x)) != resolvent.shared.end();
+      resolve_shared(itp, aig.input(Lit(x - shift)), negative ? resolvent : other, negative ? other : resolvent, aig);
     } else {
-      // Single clause
-      node->label = Lit(*next_free);
-      *next_free += 1;
-      tseitin_or(node->label, clauses[0][0], clauses[0][1], result);
-    }
-  } else {
-    // Contains two clauses (potentially unit)
-    Lit label1;
-    Lit label2;
-    if(clauses[0].size() == 1) 
-      label1 = clauses[0][0];
-    else {
-      label1 = Lit(*next_free); *next_free += 1;
-      tseitin_or(label1, clauses[0][0], clauses[0][1], result);
+      // Resolved on A
+      resolve_A(itp, resolvent, other, aig);
     }
-    if(clauses[1].size() == 1) 
-      label2 = clauses[1][0];
-    else {
-      label2 = Lit(*next_free); *next_free += 1;
-      tseitin_or(label2, clauses[1][0], clauses[1][1], result);
+
+    if(!other.shared.empty() || is_shared(x)) {
+      vector<Lit> lits;
+      for(Lit p : resolvent.shared)
+	if(var(p) != x)
+	  lits.push_back(p);
+      for(Lit p : other.shared)
+	if(var(p) != x)
+	  lits.push_back(p);
+      sort(lits.begin(), lits.end());
+      lits.erase(unique(lits.begin(), lits.end()), lits.end());
+      resolvent.shared.swap(lits);
     }
-    node->label = Lit(*next_free); *next_free += 1;
-    tseitin_and(node->label, label1, label2, result);
+    resolvent.int_trivial = itp.int_trivial;
+    resolvent.label = itp.label;
   }
+  store(next_id++, resolvent);
 }
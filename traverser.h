@@ -4,30 +4,53 @@
 #include "MiniSat-p_v1.14/Proof.h"
 #include "MiniSat-p_v1.14/Sort.h"
 #include "util.h"
+#include "aig.h"
 #include <iostream>
 #include <vector>
 #include <set>
 #include <memory>
+#include <unordered_map>
 
 using namespace std;
 
 // Used in interpolant computation to denote T/F interpolant
 enum Trivial { int_t, int_f, int_undef };
 
+// Role of a variable in the interpolation problem A /\ B
+// Tables of localities are indexed by variable, variables beyond their end are local to A
+enum Locality { local_a, local_b, shared_ab };
+
+inline Locality locality_of(const vector<char>& locality, Var x) {
+  return x < (Var)locality.size() ? (Locality)locality[x] : local_a;
+}
+
+// Partial interpolant of a clause
+// Either True or False, or int_trivial is int_undef and label is its literal in an AigManager
+struct Interpolant {
+  Trivial int_trivial=int_undef;
+  Lit label = lit_Undef;
+
+  bool done() const { return int_trivial != int_undef || label != lit_Undef; }
+  // The interpolant as literal of the AigManager
+  Lit aig() const { return int_trivial == int_t ? aig_true : int_trivial == int_f ? aig_false : label; }
+  void set(Lit x);
+};
+
+// Interpolation rules for a resolution on a variable local to B, local to A, or shared
+// The negative (positive) antecedent is the one containing the pivot negatively (positively)
+// The interpolant is built in aig, x is the literal of a shared pivot there
+void resolve_B(Interpolant& node, const Interpolant& negative, const Interpolant& positive, AigManager& aig);
+void resolve_A(Interpolant& node, const Interpolant& negative, const Interpolant& positive, AigManager& aig);
+void resolve_shared(Interpolant& node, Lit x, const Interpolant& negative, const Interpolant& positive, AigManager& aig);
+
 // A node of a resolution proof
-// Holds clause id and the literal resolved on
-// If interpolant computed, either True or False, or int_trivial is int_undef and it holds a clause
-// Additionally since we tseitinize the interpolant holds the corresponding label
-class Node {
+// Nodes live in the arena of a ResolutionForest and refer to each other by 32-bit index
+// Leaves and the last node of each resolution chain hold the clause id, inner chain nodes hold -1
+class Node : public Interpolant {
 public:
   int clause_id=-1;
   Var resolved_on=var_Undef;
-  shared_ptr<Node> negative=NULL, positive=NULL;
-
-  // Label is top-level label of tseitin translation
-  // Attention: We might just have a label if the interpolant is a unit clause
-  Trivial int_trivial=int_undef;
-  Lit label = lit_Undef;
+  int negative=-1, positive=-1;
   
   Node(){}
   Node(Var x) : resolved_on(x) {}
@@ -43,27 +66,78 @@ public:
 
 class ResolutionForest {
 public:
-  vector<shared_ptr<Node>> roots;
+  // All nodes of the proof DAG, children always precede their parents
+  vector<Node> nodes;
+  // Node of every clause id, -1 for clauses outside the proof core
+  vector<int> roots;
 
   void print();
-  void print_subtree(shared_ptr<Node> it);
-  void compute_partial_interpolant(shared_ptr<Node> node, set<Var> *shared, Var lowest_b, Var highest_b, int index, Var *next_free, vec<vec<Lit>>& result);
-  void resolve_B(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result);
-  void resolve_A(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result);
-  void resolve_shared(shared_ptr<Node> node, Var *next_free, vec<vec<Lit>>& result);
+  void print_subtree(int it);
+  // The interpolant is built in aig, with shared variables renamed to x - shift
+  void compute_partial_interpolant(int node, const vector<char>& locality, int shift, AigManager& aig);
 };
 
+// While the solver runs the trace is only recorded
+// The forest is built by finalize(), for the clauses the final conflict depends on
 struct Traverser : public ProofTraverser {
   Trivial init = int_undef;
   vec<vec<Lit>> clauses;
 
   ResolutionForest forest;
 
+  // Per clause id: partition of a root clause, or derived for a resolution chain
+  enum { derived = -1 };
+  vector<signed char> kind;
+  // trace[start[id]] .. trace[start[id+1]-1] holds the literal indices of a root clause
+  // or the chain cs[0], xs[0], cs[1], ..., cs[n] of a derived clause
+  vector<int> start = {0};
+  vector<int> trace;
+
   bool resolve(vec<Lit>& main, vec<Lit>& other, Var x);
   void root(const vec<Lit>& c);
   void chain(const vec<ClauseId>& cs, const vec<Var>& xs);
-  void deleted(ClauseId c) {
-    clauses[c].clear();
-  }
+  // Builds the forest for the core of goal, replacing the previous one
+  // Returns the number of clauses in the core
+  int finalize(ClauseId goal);
+  // Bytes held by the trace and the forest
+  size_t bytes() const;
+  // Peak bytes of clauses during the last finalize
+  size_t peak_clause_bytes = 0;
+
+private:
+  void add_root(ClauseId id);
+  void add_chain(ClauseId id);
+};
+// Computes the partial interpolant of every clause in aig as soon as the proof delivers it
+// Shared variables x are renamed to x - shift in the interpolant
+// Per live clause only its interpolant and its literals over shared variables are kept,
+// the latter determine the polarity of shared pivots. Clauses with interpolant True and
+// no shared literals, e.g. most of the derivations purely in B, are not stored at all
+struct InterpolatingTraverser : public ProofTraverser {
+  Trivial init = int_undef;
+
+  InterpolatingTraverser(const vector<char>& locality, int shift, AigManager& aig);
+  void root(const vec<Lit>& c);
+  void chain(const vec<ClauseId>& cs, const vec<Var>& xs);
+  void deleted(ClauseId c) { partials.erase(c); }
+  // The interpolant of goal as literal of the AigManager
+  Lit finish(ClauseId goal) { return lookup(goal).aig(); }
+  // Bytes held by the stored partial interpolants
+  size_t bytes() const;
+
+private:
+  struct Partial : public Interpolant {
+    vector<Lit> shared;
+  };
+
+  const vector<char>& locality;
+  int shift;
+  AigManager& aig;
+  ClauseId next_id = 0;
+  unordered_map<ClauseId, Partial> partials;
+
+  bool is_shared(Var x) const { return locality_of(locality, x) == shared_ab; }
+  const Partial& lookup(ClauseId c) const;
+  void store(ClauseId c, const Partial& p);
 };
 #endif
@@ -5,6 +5,26 @@
 
 using namespace std;
 
+Proof* attach_proof(Solver& s, ProofPolicy policy, ProofTraverser* trav) {
+  switch(policy) {
+  case proof_online:
+    s.proof = new Proof(*trav);
+    break;
+  case proof_offline:
+    s.proof = new Proof();
+    break;
+  case proof_none:
+    s.proof = NULL;
+    break;
+  }
+  return s.proof;
+}
+
+void configure(Solver& s, const SolverOptions& options) {
+  s.setRandomSeed(options.seed);
+  s.interrupt = options.interrupt;
+}
+
 void tseitin_or(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result) {
   vec<Lit> lits;
   // C1
@@ -39,6 +59,29 @@ void tseitin_and(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result) {
   result.push(); lits.copyTo(result.last());
 }
 
+// Plaisted-Greenbaum variant: label -> x1 /\ x2 is only needed if label occurs positively,
+// x1 /\ x2 -> label only if it occurs negatively
+void tseitin_and(Lit label, Lit x1, Lit x2, bool positive, bool negative, vec<vec<Lit>>& result) {
+  vec<Lit> lits;
+  if(positive) {
+    // C1
+    lits.push(~label);
+    lits.push(x1);
+    result.push(); lits.copyTo(result.last()); lits.clear();
+    // C2
+    lits.push(~label);
+    lits.push(x2);
+    result.push(); lits.copyTo(result.last()); lits.clear();
+  }
+  if(negative) {
+    // C3
+    lits.push(label);
+    lits.push(~x1);
+    lits.push(~x2);
+    result.push(); lits.copyTo(result.last());
+  }
+}
+
 void tseitin_iff(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result) {
   vec<Lit> lits;
   //C1
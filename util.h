@@ -1,12 +1,39 @@
+#ifndef UTIL_H
+#define UTIL_H
+
 #include "MiniSat-p_v1.14/Global.h"
 #include "MiniSat-p_v1.14/SolverTypes.h"
 #include "MiniSat-p_v1.14/Solver.h"
 #include <string>
+#include <atomic>
+
+// How a solver logs its resolution proof
+// proof_none: nothing is logged, for queries that never interpolate
+// proof_online: proof events are passed to a traverser as they happen
+// proof_offline: proof is written to a temporary file that can be traversed later
+enum ProofPolicy { proof_none, proof_online, proof_offline };
+
+// Settings of every solver an engine creates
+// seed: random seed of the decision heuristic, MiniSat's default unless set
+// interrupt: shared flag that makes solving throw Interrupted once it is set, NULL if never interrupted
+struct SolverOptions {
+  double seed = 91648253;
+  const std::atomic<bool>* interrupt = NULL;
+};
+
+// Applies options to s
+void configure(Solver& s, const SolverOptions& options);
+
+// Sets up proof logging of s according to policy, trav is only used in online mode
+// Has to be called before any variable is created. The returned proof (NULL for proof_none) is owned by the caller
+Proof* attach_proof(Solver& s, ProofPolicy policy, ProofTraverser* trav = NULL);
 
 void tseitin_or(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result);
 
 void tseitin_and(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result);
 
+void tseitin_and(Lit label, Lit x1, Lit x2, bool positive, bool negative, vec<vec<Lit>>& result);
+
 void tseitin_iff(Lit label, Lit x1, Lit x2, vec<vec<Lit>>& result);
 
 void print_clause(vec<Lit>& clause);
@@ -16,4 +43,4 @@ void print_model(Solver &s);
 void print_cnf(vec<vec<Lit>>& clauses, std::string name);
 
 Lit shift_literal(Lit x, int offset); 
-
+#endif